@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// read throughput of the vfs: the copying lookup the vfs used to do (entry
+// copied out under a mutex, then copied again into a std::string for JS_Eval)
+// against today's read_file(), which hands out a shared view of the bytes
+
+#include "core/vfs.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+class copying_vfs {
+public:
+    struct file_entry {
+        std::vector<uint8_t> data;
+        std::string mime_type;
+        uint64_t hash = 0;
+    };
+    
+    void register_file(const std::string& path, const std::string& data, const std::string& mime) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        files_[path] = file_entry{{data.begin(), data.end()}, mime, valkyrie::fnv1a_hash(data.data(), data.size())};
+    }
+    
+    std::optional<file_entry> read_file(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = files_.find(path);
+        if (it != files_.end()) return it->second;
+        return std::nullopt;
+    }
+    
+private:
+    std::unordered_map<std::string, file_entry> files_;
+    std::mutex mutex_;
+};
+
+template <typename F>
+double ns_per_read(int reads, F&& read) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < reads; i++) read();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / reads;
+}
+
+} // namespace
+
+int main() {
+    const size_t sizes[] = {1 << 10, 64 << 10, 1 << 20, 5 << 20};
+    copying_vfs old_vfs;
+    size_t sink = 0;
+    
+    std::printf("%10s %16s %16s %10s\n", "size", "copy ns/read", "view ns/read", "speedup");
+    for (size_t size : sizes) {
+        std::string path = "bench/" + std::to_string(size) + ".js";
+        std::string data(size, 'x');
+        old_vfs.register_file(path, data, "application/javascript");
+        valkyrie::vfs::instance().register_file(path, data, "application/javascript");
+        
+        int reads = size >= (1 << 20) ? 200 : 20000;
+        double copy = ns_per_read(reads, [&]() {
+            auto file = old_vfs.read_file(path);
+            std::string code((const char*)file->data.data(), file->data.size());
+            sink += code.size();
+        });
+        double view = ns_per_read(reads, [&]() {
+            auto file = valkyrie::vfs::instance().read_file(path);
+            sink += file->text().size();
+        });
+        std::printf("%10zu %16.1f %16.1f %9.0fx\n", size, copy, view, copy / view);
+    }
+    
+    // keeps the reads from being optimised away
+    return sink == 0;
+}
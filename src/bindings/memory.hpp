@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "../core/allocator.hpp"
+#include <quickjs/quickjs.h>
+#include <uv.h>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <csignal>
+
+namespace valkyrie {
+
+static JSRuntime* g_memory_rt = nullptr;
+#ifndef _WIN32
+static uv_signal_t g_memory_signal;
+static bool g_memory_signal_ready = false;
+#endif
+
+static void set_int64(JSContext* ctx, JSValue obj, const char* name, int64_t value) {
+    JS_SetPropertyStr(ctx, obj, name, JS_NewInt64(ctx, value));
+}
+
+static void set_count_size(JSContext* ctx, JSValue obj, const char* name, int64_t count, int64_t size) {
+    JSValue entry = JS_NewObject(ctx);
+    set_int64(ctx, entry, "count", count);
+    set_int64(ctx, entry, "size", size);
+    JS_SetPropertyStr(ctx, obj, name, entry);
+}
+
+// process.memoryUsage(): node-style totals plus the QuickJS breakdown
+static JSValue js_memory_usage(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    JSMemoryUsage usage;
+    JS_ComputeMemoryUsage(JS_GetRuntime(ctx), &usage);
+    
+    size_t rss = 0;
+    uv_resident_set_memory(&rss);
+    
+    JSValue ret = JS_NewObject(ctx);
+    set_int64(ctx, ret, "rss", (int64_t)rss);
+    set_int64(ctx, ret, "heapTotal", usage.malloc_size);
+    set_int64(ctx, ret, "heapUsed", usage.memory_used_size);
+    set_int64(ctx, ret, "heapLimit", usage.malloc_limit);
+    set_int64(ctx, ret, "mallocCount", usage.malloc_count);
+    set_count_size(ctx, ret, "atoms", usage.atom_count, usage.atom_size);
+    set_count_size(ctx, ret, "strings", usage.str_count, usage.str_size);
+    set_count_size(ctx, ret, "objects", usage.obj_count, usage.obj_size);
+    set_count_size(ctx, ret, "properties", usage.prop_count, usage.prop_size);
+    set_count_size(ctx, ret, "shapes", usage.shape_count, usage.shape_size);
+    set_count_size(ctx, ret, "functions", usage.js_func_count, usage.js_func_size + usage.js_func_code_size);
+    set_count_size(ctx, ret, "binaryObjects", usage.binary_object_count, usage.binary_object_size);
+    set_int64(ctx, ret, "cFunctions", usage.c_func_count);
+    set_int64(ctx, ret, "arrays", usage.array_count);
+    set_int64(ctx, ret, "fastArrays", usage.fast_array_count);
+    
+#ifndef VALKYRIE_SYSTEM_MALLOC
+    allocator_stats stats = pool_allocator_stats();
+    JSValue allocator = JS_NewObject(ctx);
+    set_int64(ctx, allocator, "allocations", (int64_t)stats.allocations);
+    set_int64(ctx, allocator, "frees", (int64_t)stats.frees);
+    set_int64(ctx, allocator, "pooled", (int64_t)stats.pooled_allocations);
+    set_int64(ctx, allocator, "bytesInUse", (int64_t)stats.bytes_in_use);
+    set_int64(ctx, allocator, "peakBytes", (int64_t)stats.peak_bytes);
+    set_int64(ctx, allocator, "slabBytes", (int64_t)stats.slab_bytes);
+    JS_SetPropertyStr(ctx, ret, "allocator", allocator);
+#endif
+    return ret;
+}
+
+// appends a JS_DumpMemoryUsage report with a timestamp header
+inline bool dump_memory_usage(JSRuntime* rt, const std::string& path) {
+    FILE* fp = fopen(path.c_str(), "a");
+    if (!fp) return false;
+    
+    JSMemoryUsage usage;
+    JS_ComputeMemoryUsage(rt, &usage);
+    size_t rss = 0;
+    uv_resident_set_memory(&rss);
+    
+    fprintf(fp, "=== valkyrie memory dump %lld (rss %zu bytes) ===\n", (long long)time(nullptr), rss);
+    JS_DumpMemoryUsage(fp, &usage, rt);
+    fprintf(fp, "\n");
+    fclose(fp);
+    return true;
+}
+
+inline std::string memory_dump_path() {
+    const char* path = getenv("VALKYRIE_MEMORY_DUMP");
+    if (path && *path) return path;
+    return "valkyrie-memory-" + std::to_string(uv_os_getpid()) + ".txt";
+}
+
+static JSValue js_dump_memory_usage(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    std::string path = memory_dump_path();
+    if (argc > 0 && JS_IsString(argv[0])) {
+        const char* arg = JS_ToCString(ctx, argv[0]);
+        if (!arg) return JS_EXCEPTION;
+        path = arg;
+        JS_FreeCString(ctx, arg);
+    }
+    if (!dump_memory_usage(JS_GetRuntime(ctx), path)) return JS_NULL;
+    return JS_NewString(ctx, path.c_str());
+}
+
+#ifndef _WIN32
+static void memory_signal_cb(uv_signal_t* handle, int signum) {
+    if (!g_memory_rt) return;
+    std::string path = memory_dump_path();
+    if (dump_memory_usage(g_memory_rt, path)) {
+        fprintf(stderr, "[memory] dumped to %s\n", path.c_str());
+    }
+}
+#endif
+
+// kill -USR2 <pid> appends a report to $VALKYRIE_MEMORY_DUMP
+inline void init_memory_signal(uv_loop_t* loop, JSRuntime* rt) {
+    g_memory_rt = rt;
+#ifndef _WIN32
+    uv_signal_init(loop, &g_memory_signal);
+    uv_signal_start(&g_memory_signal, memory_signal_cb, SIGUSR2);
+    uv_unref((uv_handle_t*)&g_memory_signal);
+    g_memory_signal_ready = true;
+#endif
+}
+
+inline void close_memory_signal() {
+    g_memory_rt = nullptr;
+#ifndef _WIN32
+    if (!g_memory_signal_ready) return;
+    uv_signal_stop(&g_memory_signal);
+    uv_close((uv_handle_t*)&g_memory_signal, nullptr);
+    g_memory_signal_ready = false;
+#endif
+}
+
+} // namespace valkyrie
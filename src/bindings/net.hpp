@@ -39,6 +39,10 @@
 #pragma once
 
 #include "../core/vfs.hpp"
+#include "../core/microtasks.hpp"
+#include "../core/errors.hpp"
+#include "../core/metrics.hpp"
+#include "../core/trace.hpp"
 #include <quickjs/quickjs.h>
 #include <uv.h>
 #include <string>
@@ -46,6 +50,7 @@
 #include <functional>
 #include <memory>
 #include <cstring>
+#include <iostream>
 #include <map>
 
 namespace valkyrie {
@@ -72,6 +77,11 @@ public:
     
     static void fetch(const http_request& req, callback_t callback) {
         auto ctx = new request_context{req, callback};
+        if (g_trace.enabled()) {
+            ctx->trace_id = g_trace.next_id();
+            g_trace.async_begin("fetch", "http", ctx->trace_id, trace_recorder::arg("url", req.url));
+            g_trace.async_begin("dns", "http", ctx->trace_id);
+        }
         
         uv_getaddrinfo_t* resolver = new uv_getaddrinfo_t();
         resolver->data = ctx;
@@ -94,10 +104,24 @@ private:
         std::string response_buffer;
         http_response response;
         bool headers_parsed = false;
+        uint64_t trace_id = 0;  // nonzero while tracing: fetch > dns, connect, wait, receive
+        bool first_byte = false;
     };
     
+    // closes the current phase span and opens the next; a null next ends the fetch
+    static void trace_phase(request_context* ctx, const char* done, const char* next) {
+        if (!ctx->trace_id || !g_trace.enabled()) return;
+        g_trace.async_end(done, "http", ctx->trace_id);
+        if (next) {
+            g_trace.async_begin(next, "http", ctx->trace_id);
+        } else {
+            g_trace.async_end("fetch", "http", ctx->trace_id);
+        }
+    }
+    
     static void on_resolved(uv_getaddrinfo_t* resolver, int status, struct addrinfo* res) {
         auto ctx = (request_context*)resolver->data;
+        trace_phase(ctx, "dns", status < 0 ? nullptr : "connect");
         
         if (status < 0) {
             ctx->callback(http_response{0, {}, {}});
@@ -119,6 +143,7 @@ private:
     
     static void on_connect(uv_connect_t* req, int status) {
         auto ctx = (request_context*)req->data;
+        trace_phase(ctx, "connect", status < 0 ? nullptr : "wait");
         
         if (status < 0) {
             ctx->callback(http_response{0, {}, {}});
@@ -165,6 +190,10 @@ private:
         auto ctx = (request_context*)stream->data;
         
         if (nread > 0) {
+            if (!ctx->first_byte) {
+                ctx->first_byte = true;
+                trace_phase(ctx, "wait", "receive");
+            }
             ctx->response_buffer.append(buf->base, nread);
             
             if (!ctx->headers_parsed) {
@@ -190,6 +219,7 @@ private:
                 ctx->response.body.assign(body_str.begin(), body_str.end());
             }
         } else if (nread < 0) {
+            trace_phase(ctx, ctx->first_byte ? "receive" : "wait", nullptr);
             if (ctx->headers_parsed) {
                 ctx->callback(ctx->response);
             } else {
@@ -246,6 +276,7 @@ static JSValue js_http_fetch(JSContext* ctx, JSValueConst this_val, int argc, JS
     JSContext* ctx_ptr = ctx;
     
     http_client::fetch(req, [ctx_ptr, resolve_ptr](http_response resp) {
+        metrics_scope scope(metric_category::http);
         JSValue obj = JS_NewObject(ctx_ptr);
         JS_SetPropertyStr(ctx_ptr, obj, "status", JS_NewInt32(ctx_ptr, resp.status_code));
         
@@ -256,10 +287,15 @@ static JSValue js_http_fetch(JSContext* ctx, JSValueConst this_val, int argc, JS
         JS_SetPropertyStr(ctx_ptr, obj, "text", JS_NewString(ctx_ptr, body_text.c_str()));
         
         JSValue args[1] = {obj};
-        JS_Call(ctx_ptr, *resolve_ptr, JS_UNDEFINED, 1, args);
+        JSValue result = JS_Call(ctx_ptr, *resolve_ptr, JS_UNDEFINED, 1, args);
+        if (JS_IsException(result)) {
+            std::cerr << "Fetch error: " << take_exception_message(ctx_ptr) << std::endl;
+        }
+        JS_FreeValue(ctx_ptr, result);
         JS_FreeValue(ctx_ptr, obj);
         JS_FreeValue(ctx_ptr, *resolve_ptr);
         delete resolve_ptr;
+        run_microtasks(ctx_ptr);
     });
     
     JS_FreeValue(ctx, resolve_func);
@@ -38,10 +38,14 @@
 
 #pragma once
 
+#include "../core/microtasks.hpp"
+#include "../core/errors.hpp"
+#include "../core/metrics.hpp"
 #include <quickjs/quickjs.h>
 #include <uv.h>
 #include <string>
 #include <cstring>
+#include <iostream>
 
 namespace valkyrie {
 
@@ -58,6 +62,14 @@ struct native_socket {
                       on_error(JS_UNDEFINED), on_close(JS_UNDEFINED), connected(false) {}
 };
 
+static void call_socket_callback(JSContext* ctx, JSValueConst callback, int argc, JSValueConst* argv) {
+    JSValue result = JS_Call(ctx, callback, JS_UNDEFINED, argc, argv);
+    if (JS_IsException(result)) {
+        std::cerr << "Socket error: " << take_exception_message(ctx) << std::endl;
+    }
+    JS_FreeValue(ctx, result);
+}
+
 static void socket_alloc_cb(uv_handle_t* handle, size_t suggested, uv_buf_t* buf) {
     buf->base = new char[suggested];
     buf->len = suggested;
@@ -65,48 +77,52 @@ static void socket_alloc_cb(uv_handle_t* handle, size_t suggested, uv_buf_t* buf
 
 static void socket_read_cb(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
     native_socket* sock = (native_socket*)stream->data;
+    metrics_scope scope(metric_category::socket);
     
     if (nread > 0) {
         if (JS_IsFunction(sock->ctx, sock->on_data)) {
             JSValue arr = JS_NewArrayBufferCopy(sock->ctx, (uint8_t*)buf->base, nread);
             JSValue args[1] = {arr};
-            JS_Call(sock->ctx, sock->on_data, JS_UNDEFINED, 1, args);
+            call_socket_callback(sock->ctx, sock->on_data, 1, args);
             JS_FreeValue(sock->ctx, arr);
         }
     } else if (nread < 0) {
         if (nread != UV_EOF && JS_IsFunction(sock->ctx, sock->on_error)) {
             JSValue err = JS_NewString(sock->ctx, uv_strerror(nread));
             JSValue args[1] = {err};
-            JS_Call(sock->ctx, sock->on_error, JS_UNDEFINED, 1, args);
+            call_socket_callback(sock->ctx, sock->on_error, 1, args);
             JS_FreeValue(sock->ctx, err);
         }
         if (nread == UV_EOF && JS_IsFunction(sock->ctx, sock->on_close)) {
-            JS_Call(sock->ctx, sock->on_close, JS_UNDEFINED, 0, nullptr);
+            call_socket_callback(sock->ctx, sock->on_close, 0, nullptr);
         }
     }
     
     delete[] buf->base;
+    run_microtasks(sock->ctx);
 }
 
 static void socket_connect_cb(uv_connect_t* req, int status) {
     native_socket* sock = (native_socket*)req->data;
+    metrics_scope scope(metric_category::socket);
     
     if (status == 0) {
         sock->connected = true;
         if (JS_IsFunction(sock->ctx, sock->on_connect)) {
-            JS_Call(sock->ctx, sock->on_connect, JS_UNDEFINED, 0, nullptr);
+            call_socket_callback(sock->ctx, sock->on_connect, 0, nullptr);
         }
         uv_read_start((uv_stream_t*)&sock->tcp, socket_alloc_cb, socket_read_cb);
     } else {
         if (JS_IsFunction(sock->ctx, sock->on_error)) {
             JSValue err = JS_NewString(sock->ctx, uv_strerror(status));
             JSValue args[1] = {err};
-            JS_Call(sock->ctx, sock->on_error, JS_UNDEFINED, 1, args);
+            call_socket_callback(sock->ctx, sock->on_error, 1, args);
             JS_FreeValue(sock->ctx, err);
         }
     }
     
     delete req;
+    run_microtasks(sock->ctx);
 }
 
 static void socket_write_cb(uv_write_t* req, int status) {
@@ -224,37 +240,6 @@ SOCKET_MAKE_SETTER(on_data, on_data)
 SOCKET_MAKE_SETTER(on_error, on_error)
 SOCKET_MAKE_SETTER(on_close, on_close)
 
-struct timer_ctx {
-    JSContext* ctx;
-    JSValue callback;
-    uv_timer_t timer;
-};
-
-static void timer_cb(uv_timer_t* handle) {
-    timer_ctx* tctx = (timer_ctx*)handle->data;
-    JS_Call(tctx->ctx, tctx->callback, JS_UNDEFINED, 0, nullptr);
-    JS_FreeValue(tctx->ctx, tctx->callback);
-    uv_close((uv_handle_t*)handle, nullptr);
-    delete tctx;
-}
-
-static JSValue js_set_timeout(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-    timer_ctx* tctx = new timer_ctx();
-    tctx->ctx = ctx;
-    tctx->callback = JS_DupValue(ctx, argv[0]);
-    
-    int delay = 0;
-    if (argc > 1) {
-        JS_ToInt32(ctx, &delay, argv[1]);
-    }
-    
-    uv_timer_init(uv_default_loop(), &tctx->timer);
-    tctx->timer.data = tctx;
-    uv_timer_start(&tctx->timer, timer_cb, delay, 0);
-    
-    return JS_UNDEFINED;
-}
-
 static JSValue js_buffer_alloc(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
     int size;
     JS_ToInt32(ctx, &size, argv[0]);
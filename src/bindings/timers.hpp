@@ -0,0 +1,382 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "../core/microtasks.hpp"
+#include "../core/errors.hpp"
+#include "../core/metrics.hpp"
+#include "../core/trace.hpp"
+#include <quickjs/quickjs.h>
+#include <uv.h>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace valkyrie {
+
+// one pooled uv_timer_t per distinct due millisecond. the handle must stay the
+// first member so the libuv callback can cast back to the slot.
+struct timer_slot {
+    uv_timer_t handle;
+    uint64_t due;
+};
+
+struct timer_entry {
+    JSValue callback;
+    std::vector<JSValue> args;
+    uint64_t due;
+    uint64_t interval; // 0 for one-shot timers and immediates
+};
+
+struct timer_bucket {
+    timer_slot* slot;
+    std::vector<int32_t> ids;
+};
+
+static void timer_slot_cb(uv_timer_t* handle);
+static void immediate_check_cb(uv_check_t* handle);
+static void immediate_idle_cb(uv_idle_t* handle) {
+    // keeps uv_run from blocking in poll while immediates are queued
+}
+
+// setTimeout/setInterval/setImmediate bookkeeping; logic thread only.
+// timers due in the same millisecond share a bucket and a single uv_timer_t,
+// and idle handles are recycled instead of being closed after every fire.
+class timer_manager {
+public:
+    static constexpr size_t MAX_IDLE_SLOTS = 64;
+    
+    void init(uv_loop_t* loop, JSContext* ctx) {
+        loop_ = loop;
+        ctx_ = ctx;
+        uv_check_init(loop, &immediate_check_);
+        immediate_check_.data = this;
+        uv_check_start(&immediate_check_, immediate_check_cb);
+        uv_idle_init(loop, &immediate_idle_);
+        ready_ = true;
+    }
+    
+    void close() {
+        if (!ready_) return;
+        ready_ = false;
+        
+        for (auto& [id, entry] : timers_) {
+            free_entry(entry);
+        }
+        timers_.clear();
+        immediates_.clear();
+        
+        for (auto& [due, bucket] : buckets_) {
+            close_slot(bucket.slot);
+        }
+        buckets_.clear();
+        for (timer_slot* slot : idle_slots_) {
+            close_slot(slot);
+        }
+        idle_slots_.clear();
+        
+        uv_close((uv_handle_t*)&immediate_check_, nullptr);
+        uv_close((uv_handle_t*)&immediate_idle_, nullptr);
+    }
+    
+    int32_t add_timer(JSValueConst callback, std::vector<JSValue> args, uint64_t delay, bool repeat) {
+        int32_t id = next_id();
+        timer_entry& entry = timers_[id];
+        entry.callback = JS_DupValue(ctx_, callback);
+        entry.args = std::move(args);
+        entry.interval = repeat ? delay : 0;
+        schedule(id, entry, uv_now(loop_) + delay);
+        return id;
+    }
+    
+    int32_t add_immediate(JSValueConst callback, std::vector<JSValue> args) {
+        int32_t id = next_id();
+        timer_entry& entry = timers_[id];
+        entry.callback = JS_DupValue(ctx_, callback);
+        entry.args = std::move(args);
+        entry.due = 0;
+        entry.interval = 0;
+        immediates_.push_back(id);
+        uv_idle_start(&immediate_idle_, immediate_idle_cb);
+        return id;
+    }
+    
+    void clear(int32_t id) {
+        auto it = timers_.find(id);
+        if (it == timers_.end()) return;
+        if (it->second.due != 0) {
+            unschedule(id, it->second.due);
+        }
+        free_entry(it->second);
+        timers_.erase(it);
+    }
+    
+    void fire(timer_slot* slot) {
+        uint64_t due = slot->due;
+        std::vector<int32_t> ids;
+        auto bucket = buckets_.find(due);
+        if (bucket != buckets_.end()) {
+            ids = std::move(bucket->second.ids);
+            buckets_.erase(bucket);
+        }
+        release_slot(slot);
+        
+        for (int32_t id : ids) {
+            auto it = timers_.find(id);
+            if (it == timers_.end() || it->second.due != due) continue;
+            
+            if (it->second.interval == 0) {
+                timer_entry entry = std::move(it->second);
+                timers_.erase(it);
+                invoke(entry);
+                free_entry(entry);
+                continue;
+            }
+            
+            // the callback may clear its own interval, so hold references across the call
+            timer_entry entry = it->second;
+            entry.callback = JS_DupValue(ctx_, entry.callback);
+            for (JSValue& arg : entry.args) arg = JS_DupValue(ctx_, arg);
+            invoke(entry);
+            free_entry(entry);
+            
+            it = timers_.find(id);
+            if (it != timers_.end() && it->second.due == due) {
+                schedule(id, it->second, uv_now(loop_) + it->second.interval);
+            }
+        }
+    }
+    
+    // runs the immediates queued before this check phase; ones added by these
+    // callbacks wait for the next loop iteration, as in node
+    void run_immediates() {
+        size_t count = immediates_.size();
+        for (size_t i = 0; i < count && !immediates_.empty(); i++) {
+            int32_t id = immediates_.front();
+            immediates_.pop_front();
+            
+            auto it = timers_.find(id);
+            if (it == timers_.end()) continue;
+            timer_entry entry = std::move(it->second);
+            timers_.erase(it);
+            invoke(entry);
+            free_entry(entry);
+        }
+        if (immediates_.empty()) {
+            uv_idle_stop(&immediate_idle_);
+        }
+    }
+    
+    size_t active_timers() const { return timers_.size(); }
+    
+private:
+    int32_t next_id() {
+        do {
+            id_counter_ = id_counter_ == INT32_MAX ? 1 : id_counter_ + 1;
+        } while (timers_.count(id_counter_));
+        return id_counter_;
+    }
+    
+    void schedule(int32_t id, timer_entry& entry, uint64_t due) {
+        entry.due = due;
+        auto [bucket, inserted] = buckets_.try_emplace(due);
+        bucket->second.ids.push_back(id);
+        if (inserted) {
+            timer_slot* slot = acquire_slot();
+            slot->due = due;
+            bucket->second.slot = slot;
+            uint64_t now = uv_now(loop_);
+            uv_timer_start(&slot->handle, timer_slot_cb, due > now ? due - now : 0, 0);
+        }
+    }
+    
+    void unschedule(int32_t id, uint64_t due) {
+        auto bucket = buckets_.find(due);
+        if (bucket == buckets_.end()) return;
+        auto& ids = bucket->second.ids;
+        for (size_t i = 0; i < ids.size(); i++) {
+            if (ids[i] == id) {
+                ids.erase(ids.begin() + i);
+                break;
+            }
+        }
+        if (ids.empty()) {
+            uv_timer_stop(&bucket->second.slot->handle);
+            release_slot(bucket->second.slot);
+            buckets_.erase(bucket);
+        }
+    }
+    
+    timer_slot* acquire_slot() {
+        if (!idle_slots_.empty()) {
+            timer_slot* slot = idle_slots_.back();
+            idle_slots_.pop_back();
+            return slot;
+        }
+        timer_slot* slot = new timer_slot();
+        uv_timer_init(loop_, &slot->handle);
+        slot->handle.data = this;
+        return slot;
+    }
+    
+    void release_slot(timer_slot* slot) {
+        if (idle_slots_.size() < MAX_IDLE_SLOTS) {
+            idle_slots_.push_back(slot);
+        } else {
+            close_slot(slot);
+        }
+    }
+    
+    static void close_slot(timer_slot* slot) {
+        uv_close((uv_handle_t*)&slot->handle, [](uv_handle_t* handle) {
+            delete (timer_slot*)handle;
+        });
+    }
+    
+    void invoke(timer_entry& entry) {
+        metrics_scope scope(metric_category::timer);
+        trace_span span(entry.interval ? "setInterval" : entry.due ? "setTimeout" : "setImmediate", "timer");
+        JSValue result = JS_Call(ctx_, entry.callback, JS_UNDEFINED, (int)entry.args.size(), entry.args.data());
+        if (JS_IsException(result)) {
+            std::cerr << "Timer error: " << take_exception_message(ctx_) << std::endl;
+        }
+        JS_FreeValue(ctx_, result);
+        run_microtasks(ctx_);
+    }
+    
+    void free_entry(timer_entry& entry) {
+        JS_FreeValue(ctx_, entry.callback);
+        for (JSValue arg : entry.args) JS_FreeValue(ctx_, arg);
+        entry.callback = JS_UNDEFINED;
+        entry.args.clear();
+    }
+    
+    uv_loop_t* loop_ = nullptr;
+    JSContext* ctx_ = nullptr;
+    bool ready_ = false;
+    int32_t id_counter_ = 0;
+    std::unordered_map<int32_t, timer_entry> timers_;
+    std::map<uint64_t, timer_bucket> buckets_;
+    std::vector<timer_slot*> idle_slots_;
+    std::deque<int32_t> immediates_;
+    uv_check_t immediate_check_;
+    uv_idle_t immediate_idle_;
+};
+
+static timer_manager g_timers;
+
+static void timer_slot_cb(uv_timer_t* handle) {
+    ((timer_manager*)handle->data)->fire((timer_slot*)handle);
+}
+
+static void immediate_check_cb(uv_check_t* handle) {
+    ((timer_manager*)handle->data)->run_immediates();
+}
+
+static std::vector<JSValue> timer_args(JSContext* ctx, int argc, JSValueConst* argv, int first) {
+    std::vector<JSValue> args;
+    for (int i = first; i < argc; i++) {
+        args.push_back(JS_DupValue(ctx, argv[i]));
+    }
+    return args;
+}
+
+// node semantics: anything below 1ms, non-numeric or past INT32_MAX becomes 1ms
+static uint64_t timer_delay(JSContext* ctx, int argc, JSValueConst* argv) {
+    double delay = 1;
+    if (argc > 1 && JS_ToFloat64(ctx, &delay, argv[1]) < 0) {
+        delay = 1;
+    }
+    if (!std::isfinite(delay) || delay < 1 || delay > INT32_MAX) {
+        delay = 1;
+    }
+    return (uint64_t)delay;
+}
+
+static JSValue js_timer_start(JSContext* ctx, int argc, JSValueConst* argv, bool repeat) {
+    if (argc == 0 || !JS_IsFunction(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "callback must be a function");
+    }
+    uint64_t delay = timer_delay(ctx, argc, argv);
+    return JS_NewInt32(ctx, g_timers.add_timer(argv[0], timer_args(ctx, argc, argv, 2), delay, repeat));
+}
+
+static JSValue js_set_timeout(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    return js_timer_start(ctx, argc, argv, false);
+}
+
+static JSValue js_set_interval(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    return js_timer_start(ctx, argc, argv, true);
+}
+
+static JSValue js_set_immediate(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc == 0 || !JS_IsFunction(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "callback must be a function");
+    }
+    return JS_NewInt32(ctx, g_timers.add_immediate(argv[0], timer_args(ctx, argc, argv, 1)));
+}
+
+// clearTimeout, clearInterval and clearImmediate share one id space
+static JSValue js_clear_timer(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    int32_t id = 0;
+    if (argc > 0 && JS_IsNumber(argv[0]) && JS_ToInt32(ctx, &id, argv[0]) == 0 && id > 0) {
+        g_timers.clear(id);
+    }
+    return JS_UNDEFINED;
+}
+
+static JSValue queue_microtask_job(JSContext* ctx, int argc, JSValueConst* argv) {
+    return JS_Call(ctx, argv[0], JS_UNDEFINED, 0, nullptr);
+}
+
+static JSValue js_queue_microtask(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc == 0 || !JS_IsFunction(ctx, argv[0])) {
+        return JS_ThrowTypeError(ctx, "callback must be a function");
+    }
+    if (JS_EnqueueJob(ctx, queue_microtask_job, 1, argv) < 0) {
+        return JS_EXCEPTION;
+    }
+    return JS_UNDEFINED;
+}
+
+} // namespace valkyrie
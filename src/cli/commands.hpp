@@ -40,13 +40,208 @@
 
 #include "utils.hpp"
 #include "cross_compile.hpp"
+#include "embed.hpp"
 #include "../core/app.hpp"
 #include <iostream>
 #include <filesystem>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
 
 namespace fs = std::filesystem;
 
-inline void run_dev() {
+struct backend_script {
+    std::string path;
+    std::string code;
+};
+
+// every .js/.mjs file under backend/, keyed by its project-relative path so
+// require()/import resolve the same way in dev and in built binaries
+inline std::vector<backend_script> collect_backend_scripts() {
+    std::vector<backend_script> scripts;
+    if (!fs::is_directory("backend")) return scripts;
+    
+    for (const auto& entry : fs::recursive_directory_iterator("backend")) {
+        if (!entry.is_regular_file()) continue;
+        std::string ext = entry.path().extension().string();
+        if (ext != ".js" && ext != ".mjs") continue;
+        std::string path = entry.path().generic_string();
+        scripts.push_back({path, read_file(path)});
+    }
+    
+    std::sort(scripts.begin(), scripts.end(), [](const backend_script& a, const backend_script& b) {
+        return a.path < b.path;
+    });
+    return scripts;
+}
+
+inline std::string backend_entry(const std::vector<backend_script>& scripts) {
+    for (const char* candidate : {"backend/main.js", "backend/main.mjs", "backend/index.js"}) {
+        for (const auto& script : scripts) {
+            if (script.path == candidate) return candidate;
+        }
+    }
+    return "";
+}
+
+// index.html plus everything it loads, keyed by APP_ASSET_ROOT plus the path
+// the page uses for them so the valkyrie:// scheme (or the inlining fallback)
+// can resolve them. The page only references the bundle; it is never pasted
+// into the HTML.
+inline std::vector<asset_file> collect_frontend_assets(bool has_npm, bool sourcemap) {
+    std::vector<asset_file> assets;
+    std::string html = read_file("index.html");
+    std::string script = has_npm ? "bundle.js" : "app.js";
+    std::string js = has_npm ? read_file("dist/bundle.js") : read_file("app.js");
+    std::string css = has_npm && fs::exists("dist/bundle.css") ? read_file("dist/bundle.css") : "";
+    
+    if (!css.empty() && html.find("\"bundle.css\"") == std::string::npos) {
+        size_t pos = html.find("</head>");
+        if (pos != std::string::npos) {
+            html.insert(pos, "<link rel=\"stylesheet\" href=\"bundle.css\">");
+        }
+    }
+    
+    if (!js.empty() && html.find("\"" + script + "\"") == std::string::npos) {
+        size_t pos = html.find("</body>");
+        if (pos != std::string::npos) {
+            html.insert(pos, "<script src=\"" + script + "\"></script>");
+        }
+    }
+    
+    assets.push_back({"index.html", std::move(html)});
+    if (!js.empty()) assets.push_back({script, std::move(js)});
+    if (!css.empty()) assets.push_back({"bundle.css", std::move(css)});
+    if (sourcemap && has_npm && fs::exists("dist/bundle.js.map")) {
+        assets.push_back({"bundle.js.map", read_file("dist/bundle.js.map")});
+    }
+    
+    // public/ is served from the page root, like most bundlers do
+    if (fs::is_directory("public")) {
+        for (auto& file : collect_directory("public")) {
+            assets.push_back(std::move(file));
+        }
+    }
+    for (auto& asset : assets) {
+        asset.path.insert(0, valkyrie::APP_ASSET_ROOT);
+    }
+    return assets;
+}
+
+inline bool json_bool(const std::string& json, const std::string& key) {
+    auto key_pos = json.find("\"" + key + "\"");
+    if (key_pos == std::string::npos) return false;
+    auto colon = json.find(":", key_pos);
+    if (colon == std::string::npos) return false;
+    auto start = json.find_first_not_of(" \t\r\n", colon + 1);
+    return start != std::string::npos && json.compare(start, 4, "true") == 0;
+}
+
+// reads a non-negative integer field such as `"memoryLimitMB": 64`; 0 when absent
+// `scale` converts units (MB to bytes, ...); values that would wrap size_t are ignored
+inline size_t json_number(const std::string& json, const std::string& key, size_t scale = 1) {
+    auto key_pos = json.find("\"" + key + "\"");
+    if (key_pos == std::string::npos) return 0;
+    auto colon = json.find(":", key_pos);
+    if (colon == std::string::npos) return 0;
+    auto start = json.find_first_not_of(" \t\r\n", colon + 1);
+    if (start == std::string::npos) return 0;
+    auto end = json.find_first_not_of("0123456789", start);
+    std::string digits = json.substr(start, end - start);
+    if (digits.empty()) return 0;
+    
+    errno = 0;
+    unsigned long long value = strtoull(digits.c_str(), nullptr, 10);
+    if (errno == ERANGE || value > SIZE_MAX / scale) {
+        std::cerr << "Warning: ignoring out-of-range \"" << key << "\" in valkyrie.json" << std::endl;
+        return 0;
+    }
+    return static_cast<size_t>(value) * scale;
+}
+
+// heap and watchdog settings from the "runtime" section of valkyrie.json:
+// { "runtime": { "memoryLimitMB": 256, "gcThresholdMB": 8, "stackSizeKB": 1024,
+//                "longTaskMs": 200, "abortLongTasks": false, "uiBatchMs": 16 } }
+inline valkyrie::runtime_options load_runtime_options() {
+    valkyrie::runtime_options options;
+    if (!fs::exists("valkyrie.json")) return options;
+    
+    std::string config = read_file("valkyrie.json");
+    auto runtime_pos = config.find("\"runtime\"");
+    if (runtime_pos == std::string::npos) return options;
+    auto open = config.find("{", runtime_pos);
+    auto close = config.find("}", open);
+    if (open == std::string::npos || close == std::string::npos) return options;
+    std::string section = config.substr(open, close - open);
+    
+    options.memory_limit = json_number(section, "memoryLimitMB", 1024 * 1024);
+    options.gc_threshold = json_number(section, "gcThresholdMB", 1024 * 1024);
+    options.max_stack_size = json_number(section, "stackSizeKB", 1024);
+    options.long_task_budget_ms = json_number(section, "longTaskMs");
+    options.abort_long_tasks = json_bool(section, "abortLongTasks");
+    if (section.find("\"uiBatchMs\"") != std::string::npos) {
+        options.ui_batch_interval_ms = json_number(section, "uiBatchMs");
+    }
+    return options;
+}
+
+inline std::string runtime_options_code(const valkyrie::runtime_options& options) {
+    std::string code = "    runtime_options options;\n";
+    if (options.memory_limit) code += "    options.memory_limit = " + std::to_string(options.memory_limit) + ";\n";
+    if (options.gc_threshold) code += "    options.gc_threshold = " + std::to_string(options.gc_threshold) + ";\n";
+    if (options.max_stack_size) code += "    options.max_stack_size = " + std::to_string(options.max_stack_size) + ";\n";
+    if (options.long_task_budget_ms) code += "    options.long_task_budget_ms = " + std::to_string(options.long_task_budget_ms) + ";\n";
+    if (options.abort_long_tasks) code += "    options.abort_long_tasks = true;\n";
+    if (options.ui_batch_interval_ms != valkyrie::UI_BATCH_DEFAULT_INTERVAL_MS) {
+        code += "    options.ui_batch_interval_ms = " + std::to_string(options.ui_batch_interval_ms) + ";\n";
+    }
+    return code;
+}
+
+// adds the backend to the app's asset pack. with `bytecode` every script is
+// compiled here and the engine detects it by mime type; build_app links the app
+// against this CLI's QuickJS so it can read it. `with_source` also ships each
+// source as a fallback for apps linked against another QuickJS.
+inline bool pack_backend_scripts(const std::vector<backend_script>& scripts, bool bytecode, bool with_source,
+                                 std::vector<asset_file>& assets) {
+    JSRuntime* rt = nullptr;
+    JSContext* ctx = nullptr;
+    if (bytecode) {
+        rt = JS_NewRuntime();
+        ctx = JS_NewContext(rt);
+    }
+    
+    bool ok = true;
+    for (const auto& script : scripts) {
+        if (!bytecode) {
+            assets.push_back({script.path, script.code, "application/javascript"});
+            continue;
+        }
+        
+        bool is_module = valkyrie::is_module_source(script.path, script.code);
+        std::vector<uint8_t> data;
+        std::string error;
+        if (!valkyrie::compile_to_bytecode(ctx, script.code.c_str(), script.code.size(), script.path.c_str(),
+                                           is_module ? JS_EVAL_TYPE_MODULE : JS_EVAL_TYPE_GLOBAL, data, &error)) {
+            print_error("Failed to compile " + script.path, error);
+            ok = false;
+            break;
+        }
+        assets.push_back({script.path, std::string(data.begin(), data.end()),
+                          is_module ? valkyrie::MODULE_BYTECODE_MIME : valkyrie::SCRIPT_BYTECODE_MIME});
+        if (with_source) {
+            assets.push_back({valkyrie::bytecode_source_path(script.path), script.code, "application/javascript"});
+        }
+    }
+    
+    if (ctx) JS_FreeContext(ctx);
+    if (rt) JS_FreeRuntime(rt);
+    return ok;
+}
+
+inline void run_dev(bool profile = false) {
     if (!fs::exists("index.html")) {
         print_error("index.html not found", "Ensure you are in a Valkyrie project directory.");
         return;
@@ -101,58 +296,43 @@ inline void run_dev() {
             print_error("Bundling failed", output);
             return;
         }
-        
-        if (fs::exists("dist/bundle.css")) {
-            std::cout << "CSS output found, will be inlined." << std::endl;
-        }
     }
     
-    std::string html = read_file("index.html");
-    std::string js;
-    
-    if (has_npm) {
-        js = read_file("dist/bundle.js");
-    } else {
-        js = read_file("app.js");
-    }
-    
-    if (html.empty()) {
+    auto assets = collect_frontend_assets(has_npm, true);
+    if (assets.front().data.empty()) {
         print_error("Failed to read index.html");
         return;
     }
-    
-    std::string css;
-    if (has_npm && fs::exists("dist/bundle.css")) {
-        css = read_file("dist/bundle.css");
+    for (const auto& asset : assets) {
+        valkyrie::vfs::instance().register_file(asset.path, asset.data, valkyrie::guess_mime_type(asset.path));
     }
     
-    if (!css.empty()) {
-        size_t pos = html.find("</head>");
-        if (pos != std::string::npos) {
-            html.insert(pos, "<style>" + css + "</style>");
-        }
-    }
+    std::cout << "Launching application...\n" << std::endl;
     
-    if (!js.empty()) {
-        size_t pos = html.find("</body>");
-        if (pos != std::string::npos) {
-            html.insert(pos, "<script>" + js + "</script>");
-        }
+    auto backend = collect_backend_scripts();
+    for (const auto& script : backend) {
+        valkyrie::vfs::instance().register_file(script.path, script.code, "application/javascript");
     }
-    
-    std::cout << "Launching application...\n" << std::endl;
+    std::string entry = backend_entry(backend);
     
     try {
-        valkyrie::app application;
+        valkyrie::runtime_options options = load_runtime_options();
+        if (profile) {
+            options.profile_path = "valkyrie.cpuprofile";
+        }
+        valkyrie::app application(options);
         application.init();
-        application.set_html(html);
+        if (!entry.empty()) {
+            application.load_from_vfs(entry);
+        }
+        application.load_page("index.html");
         application.run("valkyrie dev", 1024, 768);
     } catch (const std::exception& e) {
         print_error("Runtime error", e.what());
     }
 }
 
-inline void build_app(const std::string& target_platform = "") {
+inline void build_app(const std::string& target_platform = "", bool bytecode = false, bool with_source = false) {
     if (!fs::exists("index.html")) {
         print_error("index.html not found");
         return;
@@ -212,37 +392,45 @@ inline void build_app(const std::string& target_platform = "") {
         }
     }
     
-    std::string html = read_file("index.html");
-    std::string js = has_npm ? read_file("dist/bundle.js") : read_file("app.js");
-    std::string css;
+    auto assets = collect_frontend_assets(has_npm, false);
+    auto backend = collect_backend_scripts();
+    std::string entry = backend_entry(backend);
     
-    if (has_npm && fs::exists("dist/bundle.css")) {
-        css = read_file("dist/bundle.css");
+    if (bytecode && is_cross) {
+        // bytecode is tied to the QuickJS build that reads it; the cross toolchain links its own copy
+        std::cout << "Note: --bytecode is ignored when cross-compiling, shipping backend sources." << std::endl;
+        bytecode = false;
     }
     
-    if (!css.empty()) {
-        size_t pos = html.find("</head>");
-        if (pos != std::string::npos) {
-            html.insert(pos, "<style>" + css + "</style>");
+    if (!backend.empty()) {
+        std::cout << "Packing " << backend.size() << " backend script(s)"
+                  << (bytecode ? " as bytecode" : "") << "..." << std::endl;
+        if (!pack_backend_scripts(backend, bytecode, with_source, assets)) {
+            return;
         }
     }
     
-    if (!js.empty()) {
-        size_t pos = html.find("</body>");
-        if (pos != std::string::npos) {
-            html.insert(pos, "<script>" + js + "</script>");
-        }
+    // assets never go through the compiler: they are packed here and appended to
+    // the stripped binary, which maps them at startup. cross builds do not link
+    // libzstd, so only native builds compress the pack.
+    std::string pack;
+    if (!build_asset_pack(assets, !is_cross, pack)) {
+        return;
     }
     
+    std::string load_backend = entry.empty() ? "" : "    application.load_from_vfs(\"" + entry + "\");\n";
+    
     std::string runner = R"(#include "src/core/app.hpp"
 using namespace valkyrie;
 
-const char* HTML = R"HTML()" + html + R"()HTML";
-
 int main() {
-    app application;
+    if (!vfs::instance().mount_self()) {
+        std::cerr << "app assets are missing or damaged" << std::endl;
+        return 1;
+    }
+)" + runtime_options_code(load_runtime_options()) + R"(    app application(options);
     application.init();
-    application.set_html(HTML);
+)" + load_backend + R"(    application.load_page("index.html");
     application.run("app", 1024, 768);
     return 0;
 }
@@ -257,6 +445,20 @@ int main() {
             return;
         }
         
+        // a macOS signature covers the whole file, so the pack goes beside the binary there
+        bool packed = false;
+        if (target == "macos") {
+            std::ofstream out(result + ".pack", std::ios::binary);
+            out << pack;
+            packed = out.good();
+        } else {
+            packed = append_asset_pack(result, pack);
+        }
+        if (!packed) {
+            print_error("Failed to write the asset pack for " + result);
+            return;
+        }
+        
         std::cout << "\nBuild complete." << std::endl;
         std::cout << "Binary: ./" << result << std::endl;
         
@@ -278,15 +480,39 @@ int main() {
         "-I" + valkyrie_dir + "/src "
         "-I" + valkyrie_dir + "/_deps/webview-src "
         "$(pkg-config --cflags --libs webkit2gtk-4.0 gtk+-3.0) "
-        "-lpthread -luv /usr/lib/quickjs/libquickjs.a";
+        "-lpthread -luv";
+#ifdef VALKYRIE_QUICKJS_LIBRARY
+    // the QuickJS this CLI links, so packed bytecode and runtime_bytecode.h load in the app
+    compile_cmd += " -I\"" VALKYRIE_QUICKJS_INCLUDE_DIR "\" \"" VALKYRIE_QUICKJS_LIBRARY "\"";
+#else
+    compile_cmd += " /usr/lib/quickjs/libquickjs.a";
+#endif
+#ifdef VALKYRIE_GENERATED_DIR
+    // the runtime_bytecode.h CMake generated for this CLI's build tree
+    compile_cmd += " -I\"" VALKYRIE_GENERATED_DIR "\" -DVALKYRIE_RUNTIME_BYTECODE";
+#endif
+#ifdef VALKYRIE_SYSTEM_MALLOC
+    // apps get the same allocator the CLI was configured with
+    compile_cmd += " -DVALKYRIE_SYSTEM_MALLOC";
+#endif
+#ifdef VALKYRIE_ZSTD
+    // the pack holds zstd entries when the CLI can compress
+    compile_cmd += " -DVALKYRIE_ZSTD -lzstd";
+#endif
     
     int exit_code = 0;
     std::string output = exec_cmd(compile_cmd, &exit_code);
     
     if (exit_code == 0) {
+        // strip first: it would drop anything appended after the last section
         exec_cmd("strip app", nullptr);
         fs::remove("_build.cpp");
         
+        if (!append_asset_pack("app", pack)) {
+            print_error("Failed to append the asset pack to app");
+            return;
+        }
+        
         std::cout << "\nBuild complete." << std::endl;
         std::cout << "Binary: ./app" << std::endl;
         
@@ -0,0 +1,361 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "utils.hpp"
+#include "../core/embedded.hpp"
+#include "../core/mime.hpp"
+#include "../core/pack.hpp"
+#include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+
+#ifdef VALKYRIE_ZSTD
+    #include <zstd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+struct asset_file {
+    std::string path;
+    std::string data;
+    std::string mime = ""; // guessed from the extension when empty
+};
+
+inline std::string asset_mime(const asset_file& file) {
+    return file.mime.empty() ? valkyrie::guess_mime_type(file.path) : file.mime;
+}
+
+inline std::string to_c_array(const std::string& name, const uint8_t* data, size_t len) {
+    std::string out = "static const unsigned char " + name + "[] = {";
+    out.reserve(out.size() + len * 4 + 8);
+    for (size_t i = 0; i < len; i++) {
+        if (i % 32 == 0) out += "\n    ";
+        out += std::to_string(data[i]);
+        out += ',';
+    }
+    out += "0};\n";
+    return out;
+}
+
+inline std::string hex_u64(uint64_t value) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "0x%016llxull", (unsigned long long)value);
+    return buf;
+}
+
+inline std::string c_string_literal(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+// zstd payload for `data`, or empty when compression is unavailable or does
+// not save at least an eighth (already-compressed images, fonts and tiny files)
+inline std::string compress_asset(const std::string& data) {
+#ifdef VALKYRIE_ZSTD
+    if (data.size() < 512) return "";
+    std::string out(ZSTD_compressBound(data.size()), '\0');
+    size_t size = ZSTD_compress(out.data(), out.size(), data.data(), data.size(), 19);
+    if (ZSTD_isError(size) || size > data.size() - data.size() / 8) return "";
+    out.resize(size);
+    return out;
+#else
+    (void)data;
+    return "";
+#endif
+}
+
+// assigns every key a displacement per bucket so embedded_slot() sends it to
+// a free slot. buckets are placed largest first; a bucket that finds no
+// displacement within the budget fails the attempt.
+inline bool build_perfect_hash(const std::vector<uint64_t>& hashes, size_t bucket_count,
+                               std::vector<uint32_t>& displacements, std::vector<size_t>& slot_of) {
+    size_t count = hashes.size();
+    std::vector<std::vector<size_t>> buckets(bucket_count);
+    for (size_t i = 0; i < count; i++) {
+        buckets[hashes[i] % bucket_count].push_back(i);
+    }
+    
+    std::vector<size_t> order(bucket_count);
+    for (size_t i = 0; i < bucket_count; i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+    
+    displacements.assign(bucket_count, 0);
+    slot_of.assign(count, 0);
+    std::vector<bool> taken(count, false);
+    std::vector<size_t> slots;
+    
+    for (size_t b : order) {
+        const auto& keys = buckets[b];
+        if (keys.empty()) break;
+        
+        bool placed = false;
+        for (uint32_t d = 0; d < (1u << 20) && !placed; d++) {
+            slots.clear();
+            placed = true;
+            for (size_t key : keys) {
+                size_t slot = valkyrie::embedded_slot(hashes[key], d, count);
+                if (taken[slot] || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    placed = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (placed) {
+                displacements[b] = d;
+                for (size_t i = 0; i < keys.size(); i++) {
+                    taken[slots[i]] = true;
+                    slot_of[keys[i]] = slots[i];
+                }
+            }
+        }
+        if (!placed) return false;
+    }
+    return true;
+}
+
+// slot of every file in a minimal perfect hash over the paths, for both the
+// generated tables and asset packs
+inline bool plan_embedded_index(const std::vector<asset_file>& files, const std::string& name,
+                                std::vector<uint32_t>& displacements, std::vector<size_t>& slot_of) {
+    std::vector<uint64_t> hashes;
+    hashes.reserve(files.size());
+    for (const auto& file : files) {
+        hashes.push_back(valkyrie::fnv1a_hash(std::string_view(file.path)));
+    }
+    
+    std::vector<size_t> sorted(files.size());
+    for (size_t i = 0; i < sorted.size(); i++) sorted[i] = i;
+    std::sort(sorted.begin(), sorted.end(), [&hashes](size_t a, size_t b) { return hashes[a] < hashes[b]; });
+    for (size_t i = 1; i < sorted.size(); i++) {
+        if (hashes[sorted[i]] == hashes[sorted[i - 1]]) {
+            print_error("Path hash collision", files[sorted[i - 1]].path + " and " + files[sorted[i]].path);
+            return false;
+        }
+    }
+    
+    size_t bucket_count = std::max<size_t>(1, files.size() / 2);
+    while (!build_perfect_hash(hashes, bucket_count, displacements, slot_of)) {
+        if (bucket_count >= files.size()) {
+            print_error("Could not build a perfect hash for " + name);
+            return false;
+        }
+        bucket_count = std::min(files.size(), bucket_count * 2);
+    }
+    return true;
+}
+
+// C++ for a `valkyrie::embedded_table` named `name` over `files`: one array per
+// file plus the index, all constant data that vfs::mount() uses in place. with
+// `compress`, files that shrink are stored as zstd and decoded on first read.
+inline bool generate_embedded_table(const std::vector<asset_file>& files, const std::string& name, std::string& out,
+                                    bool compress = false) {
+    std::vector<uint32_t> displacements;
+    std::vector<size_t> slot_of;
+    if (!plan_embedded_index(files, name, displacements, slot_of)) return false;
+    
+    std::vector<size_t> file_at(files.size());
+    std::vector<std::string> compressed(files.size());
+    size_t original_bytes = 0;
+    size_t stored_bytes = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        file_at[slot_of[i]] = i;
+        if (compress) compressed[i] = compress_asset(files[i].data);
+        const std::string& stored = compressed[i].empty() ? files[i].data : compressed[i];
+        out += to_c_array(name + "_" + std::to_string(i), (const uint8_t*)stored.data(), stored.size());
+        original_bytes += files[i].data.size();
+        stored_bytes += stored.size();
+    }
+    
+    if (stored_bytes != original_bytes) {
+        out = "#ifndef VALKYRIE_ZSTD\n#error \"" + name + " holds zstd entries; define VALKYRIE_ZSTD and link libzstd\"\n#endif\n\n" + out;
+        std::cout << name << ": " << original_bytes / 1024 << " KB compressed to " << stored_bytes / 1024 << " KB" << std::endl;
+    }
+    
+    out += "\nstatic constexpr valkyrie::embedded_file " + name + "_FILES[] = {\n";
+    for (size_t slot = 0; slot < files.size(); slot++) {
+        size_t i = file_at[slot];
+        const auto& file = files[i];
+        size_t stored_size = compressed[i].empty() ? file.data.size() : compressed[i].size();
+        out += "    {" + c_string_literal(file.path) + ", " + name + "_" + std::to_string(i) + ", " +
+               std::to_string(stored_size) + ", " + c_string_literal(asset_mime(file)) + ", " +
+               hex_u64(valkyrie::fnv1a_hash(file.data.data(), file.data.size())) +
+               (compressed[i].empty() ? "" : ", \"zstd\"") + "},\n";
+    }
+    if (files.empty()) out += "    {\"\", nullptr, 0, \"\", 0},\n";
+    out += "};\n\nstatic constexpr uint32_t " + name + "_DISPLACEMENTS[] = {";
+    for (size_t i = 0; i < displacements.size(); i++) {
+        if (i % 16 == 0) out += "\n    ";
+        out += std::to_string(displacements[i]) + ",";
+    }
+    out += "\n};\n\nstatic constexpr valkyrie::embedded_table " + name + "{" + name + "_FILES, " +
+           std::to_string(files.size()) + ", " + name + "_DISPLACEMENTS, " + std::to_string(displacements.size()) + "};\n";
+    return true;
+}
+
+// the asset pack for `files` in the layout valkyrie::asset_pack maps; see core/pack.hpp
+inline bool build_asset_pack(const std::vector<asset_file>& files, bool compress, std::string& pack) {
+    std::vector<uint32_t> displacements;
+    std::vector<size_t> slot_of;
+    if (!plan_embedded_index(files, "asset pack", displacements, slot_of)) return false;
+    
+    auto align = [&pack](size_t alignment) {
+        pack.resize((pack.size() + alignment - 1) / alignment * alignment, '\0');
+    };
+    auto append = [&pack](const void* data, size_t size) {
+        pack.append((const char*)data, size);
+    };
+    
+    std::vector<valkyrie::pack_entry> entries(files.size());
+    std::string strings;
+    auto add_string = [&strings](const std::string& text, uint32_t& offset, uint32_t& size) {
+        offset = (uint32_t)strings.size();
+        size = (uint32_t)text.size();
+        strings += text;
+    };
+    
+    size_t original_bytes = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        const auto& file = files[i];
+        std::string compressed = compress ? compress_asset(file.data) : "";
+        const std::string& stored = compressed.empty() ? file.data : compressed;
+        
+        align(valkyrie::PACK_ALIGNMENT);
+        auto& entry = entries[slot_of[i]];
+        entry.data_offset = pack.size();
+        entry.size = stored.size();
+        entry.hash = valkyrie::fnv1a_hash(file.data.data(), file.data.size());
+        append(stored.data(), stored.size());
+        pack += '\0';
+        original_bytes += file.data.size();
+        
+        add_string(file.path, entry.path_offset, entry.path_size);
+        add_string(asset_mime(file), entry.mime_offset, entry.mime_size);
+        add_string(compressed.empty() ? "" : "zstd", entry.encoding_offset, entry.encoding_size);
+    }
+    
+    align(8);
+    size_t index_offset = pack.size();
+    valkyrie::pack_index_header header{(uint32_t)files.size(), (uint32_t)displacements.size()};
+    size_t strings_offset = valkyrie::pack_entries_offset(header.bucket_count) + entries.size() * sizeof(valkyrie::pack_entry);
+    for (auto& entry : entries) {
+        entry.path_offset += strings_offset;
+        entry.mime_offset += strings_offset;
+        entry.encoding_offset += strings_offset;
+    }
+    
+    append(&header, sizeof(header));
+    append(displacements.data(), displacements.size() * sizeof(uint32_t));
+    pack.resize(index_offset + valkyrie::pack_entries_offset(header.bucket_count), '\0');
+    append(entries.data(), entries.size() * sizeof(valkyrie::pack_entry));
+    pack += strings;
+    
+    valkyrie::pack_trailer trailer;
+    memcpy(trailer.magic, valkyrie::PACK_MAGIC, sizeof(trailer.magic));
+    trailer.index_offset = index_offset;
+    trailer.index_size = pack.size() - index_offset;
+    trailer.pack_size = pack.size() + sizeof(trailer);
+    append(&trailer, sizeof(trailer));
+    
+    std::cout << "Asset pack: " << files.size() << " file(s), " << original_bytes / 1024 << " KB -> "
+              << pack.size() / 1024 << " KB" << std::endl;
+    return true;
+}
+
+// pads `binary` to PACK_ALIGNMENT so blob alignment holds in memory, then appends the pack
+inline bool append_asset_pack(const std::string& binary, const std::string& pack) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(binary, ec);
+    if (ec) return false;
+    
+    std::ofstream out(binary, std::ios::binary | std::ios::app);
+    if (!out) return false;
+    std::string padding((valkyrie::PACK_ALIGNMENT - size % valkyrie::PACK_ALIGNMENT) % valkyrie::PACK_ALIGNMENT, '\0');
+    out << padding << pack;
+    return out.good();
+}
+
+// every regular file under `dir`, keyed by its path relative to `dir`
+inline std::vector<asset_file> collect_directory(const std::string& dir) {
+    std::vector<asset_file> files;
+    for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+        if (!entry.is_regular_file()) continue;
+        std::ifstream in(entry.path(), std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        files.push_back({fs::relative(entry.path(), dir).generic_string(), std::move(data)});
+    }
+    std::sort(files.begin(), files.end(), [](const asset_file& a, const asset_file& b) { return a.path < b.path; });
+    return files;
+}
+
+// `valkyrie embed <dir>`: writes a header defining the table `name`; an app
+// includes it and calls vfs::instance().mount(name). keys are the paths below
+// `dir` with `prefix` in front ("www/" makes them reachable from the page).
+inline void embed_directory(const std::string& dir, const std::string& output, const std::string& name,
+                            bool compress = false, const std::string& prefix = "") {
+    if (!fs::is_directory(dir)) {
+        print_error(dir + " is not a directory");
+        return;
+    }
+    
+    auto files = collect_directory(dir);
+    for (auto& file : files) {
+        file.path.insert(0, prefix);
+    }
+    std::string table;
+    if (!generate_embedded_table(files, name, table, compress)) return;
+    
+    std::string header = "// generated by `valkyrie embed " + dir + "`, do not edit\n"
+                         "#pragma once\n\n"
+                         "#include \"src/core/embedded.hpp\"\n\n" + table;
+    write_file(output, header);
+    std::cout << "Embedded " << files.size() << " file(s) from " << dir << " into " << output
+              << " as " << name << std::endl;
+}
@@ -58,6 +58,7 @@ Commands:
     init [name]         Create a new project
     dev                 Start development server
     build [--target]    Build production binary
+    embed <dir>         Generate a header embedding <dir> as a vfs table
     package [--target]  Create distribution package
     run                 Execute built application
     version             Display version
@@ -67,6 +68,13 @@ Flags:
     --target=linux      Target Linux (.deb/.rpm/.pkg)
     --target=windows    Target Windows (.exe)
     --target=macos      Target macOS (.app/.dmg)
+    --bytecode          Precompile backend/ scripts to QuickJS bytecode (build)
+    --bytecode-with-source  Also pack each script's source as a fallback (build)
+    --profile           Sample backend JS into valkyrie.cpuprofile (dev)
+    --out=<file>        Header to write (embed, default embedded_assets.h)
+    --name=<ident>      Name of the generated table (embed, default EMBEDDED_ASSETS)
+    --compress          Store files that shrink as zstd (embed, needs VALKYRIE_ZSTD)
+    --prefix=<dir/>     Prefix for the embedded paths (embed, www/ serves them to the page)
 
 Examples:
     valkyrie init my-app
@@ -94,17 +102,56 @@ int main(int argc, char** argv) {
         }
         create_project(name);
     } else if (cmd == "dev") {
-        run_dev();
+        bool profile = false;
+        for (int i = 2; i < argc; i++) {
+            if (std::string(argv[i]) == "--profile") {
+                profile = true;
+            }
+        }
+        run_dev(profile);
     } else if (cmd == "build") {
         std::string target = get_platform();
-        if (argc > 2) {
-            std::string arg = argv[2];
+        bool bytecode = false;
+        bool with_source = false;
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
             if (arg.find("--target=") == 0) {
                 target = arg.substr(9);
+            } else if (arg == "--bytecode") {
+                bytecode = true;
+            } else if (arg == "--bytecode-with-source") {
+                bytecode = true;
+                with_source = true;
             }
         }
         
-        build_app(target);
+        build_app(target, bytecode, with_source);
+    } else if (cmd == "embed") {
+        std::string dir;
+        std::string output = "embedded_assets.h";
+        std::string name = "EMBEDDED_ASSETS";
+        std::string prefix;
+        bool compress = false;
+        for (int i = 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--compress") {
+                compress = true;
+            } else if (arg.find("--prefix=") == 0) {
+                prefix = arg.substr(9);
+            } else if (arg.find("--out=") == 0) {
+                output = arg.substr(6);
+            } else if (arg.find("--name=") == 0) {
+                name = arg.substr(7);
+            } else {
+                dir = arg;
+            }
+        }
+        
+        if (dir.empty()) {
+            print_error("usage: valkyrie embed <dir> [--out=<file>] [--name=<ident>] [--prefix=<dir/>] [--compress]");
+            return 1;
+        }
+        embed_directory(dir, output, name, compress, prefix);
     } else if (cmd == "package") {
         std::string target = "";
         if (argc > 2) {
@@ -114,7 +161,7 @@ int main(int argc, char** argv) {
                 std::cout << "packaging for target: " << target << "\n" << std::endl;
             }
         }
-        package_app(target, build_app);
+        package_app(target, [](const std::string& t) { build_app(t); });
     } else if (cmd == "run") {
         if (fs::exists("app")) {
             system("./app");
@@ -204,6 +204,10 @@ inline void create_macos_app(const std::string& app_name, const std::string& ver
     fs::create_directories(resources);
     
     exec_cmd("cp app " + macos_dir + "/" + app_name, nullptr);
+    if (fs::exists("app.pack")) {
+        // macOS builds keep their asset pack beside the executable
+        exec_cmd("cp app.pack " + macos_dir + "/" + app_name + ".pack", nullptr);
+    }
     
     std::string plist = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
     plist += "<!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">\n";
@@ -0,0 +1,350 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <quickjs/quickjs.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(VALKYRIE_SYSTEM_MALLOC)
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+#endif
+
+namespace valkyrie {
+
+struct allocator_stats {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t pooled_allocations = 0; // served from a size-class free list or slab
+    uint64_t bytes_in_use = 0;
+    uint64_t peak_bytes = 0;
+    uint64_t slab_bytes = 0;         // memory reserved for the size-class pools
+};
+
+// set when QuickJS is refused memory on this thread, by the heap limit or by
+// malloc itself. errors.hpp reads it to tell out-of-memory apart from other errors.
+inline bool& allocation_failed_flag() {
+    static thread_local bool failed = false;
+    return failed;
+}
+
+inline void* record_allocation_failure() {
+    allocation_failed_flag() = true;
+    return nullptr;
+}
+
+// true if an allocation failed since the last call
+inline bool take_allocation_failure() {
+    bool failed = allocation_failed_flag();
+    allocation_failed_flag() = false;
+    return failed;
+}
+
+#ifndef VALKYRIE_SYSTEM_MALLOC
+
+// QuickJS allocator backed by thread-local size-class pools. every block carries
+// a 16-byte header so free/realloc/usable_size need no lookup. a runtime is only
+// ever touched by the thread that created it, so the pools need no locking;
+// blocks of up to POOL_MAX_SIZE bytes are recycled, larger ones go to malloc.
+static constexpr size_t POOL_MAX_SIZE = 512;
+static constexpr size_t POOL_SLAB_SIZE = 64 * 1024;
+static constexpr uint32_t POOL_LARGE_CLASS = UINT32_MAX;
+static constexpr size_t POOL_CLASS_SIZES[] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512
+};
+static constexpr size_t POOL_CLASS_COUNT = sizeof(POOL_CLASS_SIZES) / sizeof(POOL_CLASS_SIZES[0]);
+
+struct alignas(16) block_header {
+    uint32_t size_class;
+    uint32_t reserved;
+    size_t size;
+};
+
+struct free_block {
+    free_block* next;
+};
+
+// size_class_lookup[(size + 15) / 16] is the smallest class that fits `size`
+struct size_class_table {
+    uint8_t index[POOL_MAX_SIZE / 16 + 1];
+    
+    constexpr size_class_table() : index() {
+        size_t cls = 0;
+        for (size_t slot = 0; slot <= POOL_MAX_SIZE / 16; slot++) {
+            while (POOL_CLASS_SIZES[cls] < slot * 16) cls++;
+            index[slot] = (uint8_t)cls;
+        }
+    }
+};
+
+static constexpr size_class_table size_class_lookup;
+
+class size_class_pool {
+public:
+    ~size_class_pool() {
+        for (void* slab : slabs_) free(slab);
+    }
+    
+    block_header* take(uint32_t cls) {
+        free_block* block = free_lists_[cls];
+        if (block) {
+            free_lists_[cls] = block->next;
+            return reinterpret_cast<block_header*>(block);
+        }
+        
+        size_t need = sizeof(block_header) + POOL_CLASS_SIZES[cls];
+        if (need > bump_left_) {
+            char* slab = static_cast<char*>(malloc(POOL_SLAB_SIZE));
+            if (!slab) return nullptr;
+            slabs_.push_back(slab);
+            stats.slab_bytes += POOL_SLAB_SIZE;
+            bump_ = slab;
+            bump_left_ = POOL_SLAB_SIZE;
+        }
+        block_header* header = reinterpret_cast<block_header*>(bump_);
+        bump_ += need;
+        bump_left_ -= need;
+        return header;
+    }
+    
+    void give(block_header* header) {
+        uint32_t cls = header->size_class;
+        free_block* block = reinterpret_cast<free_block*>(header);
+        block->next = free_lists_[cls];
+        free_lists_[cls] = block;
+    }
+    
+    allocator_stats stats;
+    
+private:
+    free_block* free_lists_[POOL_CLASS_COUNT] = {};
+    std::vector<void*> slabs_;
+    char* bump_ = nullptr;
+    size_t bump_left_ = 0;
+};
+
+inline size_class_pool& local_pool() {
+    static thread_local size_class_pool pool;
+    return pool;
+}
+
+inline size_t pool_usable_size(const block_header* header) {
+    return header->size_class == POOL_LARGE_CLASS ? header->size : POOL_CLASS_SIZES[header->size_class];
+}
+
+inline void* pool_alloc_block(size_t size) {
+    size_class_pool& pool = local_pool();
+    block_header* header;
+    
+    if (size <= POOL_MAX_SIZE) {
+        uint32_t cls = size_class_lookup.index[(size + 15) >> 4];
+        header = pool.take(cls);
+        if (!header) return nullptr;
+        header->size_class = cls;
+        header->size = POOL_CLASS_SIZES[cls];
+        pool.stats.pooled_allocations++;
+    } else {
+        header = static_cast<block_header*>(malloc(sizeof(block_header) + size));
+        if (!header) return nullptr;
+        header->size_class = POOL_LARGE_CLASS;
+        header->size = size;
+    }
+    
+    pool.stats.allocations++;
+    pool.stats.bytes_in_use += header->size;
+    if (pool.stats.bytes_in_use > pool.stats.peak_bytes) {
+        pool.stats.peak_bytes = pool.stats.bytes_in_use;
+    }
+    return header + 1;
+}
+
+inline void pool_free_block(void* ptr) {
+    block_header* header = static_cast<block_header*>(ptr) - 1;
+    size_class_pool& pool = local_pool();
+    pool.stats.frees++;
+    pool.stats.bytes_in_use -= header->size;
+    
+    if (header->size_class == POOL_LARGE_CLASS) {
+        free(header);
+    } else {
+        pool.give(header);
+    }
+}
+
+static size_t js_pool_usable_size(const void* ptr) {
+    if (!ptr) return 0;
+    return pool_usable_size(static_cast<const block_header*>(ptr) - 1);
+}
+
+// the JSMallocState bookkeeping mirrors js_def_malloc so JS_SetMemoryLimit,
+// JS_ComputeMemoryUsage and the GC threshold keep working unchanged
+static void* js_pool_malloc(JSMallocState* s, size_t size) {
+    if (s->malloc_size + size > s->malloc_limit) return record_allocation_failure();
+    void* ptr = pool_alloc_block(size);
+    if (!ptr) return record_allocation_failure();
+    s->malloc_count++;
+    s->malloc_size += js_pool_usable_size(ptr) + sizeof(block_header);
+    return ptr;
+}
+
+static void js_pool_free(JSMallocState* s, void* ptr) {
+    if (!ptr) return;
+    s->malloc_count--;
+    s->malloc_size -= js_pool_usable_size(ptr) + sizeof(block_header);
+    pool_free_block(ptr);
+}
+
+static void* js_pool_realloc(JSMallocState* s, void* ptr, size_t size) {
+    if (!ptr) {
+        if (size == 0) return nullptr;
+        return js_pool_malloc(s, size);
+    }
+    if (size == 0) {
+        js_pool_free(s, ptr);
+        return nullptr;
+    }
+    
+    size_t old_size = js_pool_usable_size(ptr);
+    // pooled blocks already have headroom up to their class size
+    if (size <= old_size && (old_size <= POOL_MAX_SIZE || size > POOL_MAX_SIZE)) {
+        return ptr;
+    }
+    if (s->malloc_size + size - old_size > s->malloc_limit) return record_allocation_failure();
+    
+    void* new_ptr = pool_alloc_block(size);
+    if (!new_ptr) return record_allocation_failure();
+    memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+    s->malloc_size += js_pool_usable_size(new_ptr);
+    s->malloc_size -= old_size;
+    pool_free_block(ptr);
+    return new_ptr;
+}
+
+static const JSMallocFunctions pool_malloc_functions = {
+    js_pool_malloc,
+    js_pool_free,
+    js_pool_realloc,
+    js_pool_usable_size,
+};
+
+#else
+
+// plain malloc with the js_def_malloc bookkeeping, wrapped only so that
+// refused allocations reach allocation_failed_flag()
+static size_t js_system_usable_size(const void* ptr) {
+    if (!ptr) return 0;
+#if defined(__APPLE__)
+    return malloc_size(ptr);
+#elif defined(_WIN32)
+    return _msize(const_cast<void*>(ptr));
+#else
+    return malloc_usable_size(const_cast<void*>(ptr));
+#endif
+}
+
+static void* js_system_malloc(JSMallocState* s, size_t size) {
+    if (s->malloc_size + size > s->malloc_limit) return record_allocation_failure();
+    void* ptr = malloc(size);
+    if (!ptr) return record_allocation_failure();
+    s->malloc_count++;
+    s->malloc_size += js_system_usable_size(ptr);
+    return ptr;
+}
+
+static void js_system_free(JSMallocState* s, void* ptr) {
+    if (!ptr) return;
+    s->malloc_count--;
+    s->malloc_size -= js_system_usable_size(ptr);
+    free(ptr);
+}
+
+static void* js_system_realloc(JSMallocState* s, void* ptr, size_t size) {
+    if (!ptr) {
+        if (size == 0) return nullptr;
+        return js_system_malloc(s, size);
+    }
+    if (size == 0) {
+        js_system_free(s, ptr);
+        return nullptr;
+    }
+    
+    size_t old_size = js_system_usable_size(ptr);
+    if (s->malloc_size + size - old_size > s->malloc_limit) return record_allocation_failure();
+    
+    void* new_ptr = realloc(ptr, size);
+    if (!new_ptr) return record_allocation_failure();
+    s->malloc_size += js_system_usable_size(new_ptr);
+    s->malloc_size -= old_size;
+    return new_ptr;
+}
+
+static const JSMallocFunctions system_malloc_functions = {
+    js_system_malloc,
+    js_system_free,
+    js_system_realloc,
+    js_system_usable_size,
+};
+
+#endif // VALKYRIE_SYSTEM_MALLOC
+
+// counters for the calling thread's pools; zero when built with the system malloc
+inline allocator_stats pool_allocator_stats() {
+#ifdef VALKYRIE_SYSTEM_MALLOC
+    return {};
+#else
+    return local_pool().stats;
+#endif
+}
+
+inline JSRuntime* new_js_runtime() {
+#ifdef VALKYRIE_SYSTEM_MALLOC
+    return JS_NewRuntime2(&system_malloc_functions, nullptr);
+#else
+    return JS_NewRuntime2(&pool_malloc_functions, nullptr);
+#endif
+}
+
+} // namespace valkyrie
@@ -40,13 +40,26 @@
 
 #include "vfs.hpp"
 #include "runtime.hpp"
+#include "bytecode.hpp"
 #include "ipc.hpp"
+#include "errors.hpp"
+#include "allocator.hpp"
+#include "microtasks.hpp"
+#include "metrics.hpp"
+#include "interrupt.hpp"
+#include "trace.hpp"
+#include "base64.hpp"
+#include "ui_batch.hpp"
+#include "scheme.hpp"
+#include "modules.hpp"
 #include "../bindings/system.hpp"
 #include "../bindings/fs.hpp"
 #include "../bindings/os.hpp"
 #include "../bindings/dialog.hpp"
 #include "../bindings/net.hpp"
 #include "../bindings/socket.hpp"
+#include "../bindings/timers.hpp"
+#include "../bindings/memory.hpp"
 
 #ifdef _WIN32
     #include <windows.h>
@@ -56,12 +69,15 @@
 #ifndef VALKYRIE_NO_WEBVIEW
     #include <core/include/webview.h>
 #endif
+#if defined(VALKYRIE_RUNTIME_BYTECODE) && __has_include("runtime_bytecode.h")
+    #include "runtime_bytecode.h"
+    #define VALKYRIE_HAS_RUNTIME_BYTECODE
+#endif
 #include <quickjs/quickjs.h>
 #include <uv.h>
 
 #include <thread>
 #include <mutex>
-#include <deque>
 #include <string>
 #include <functional>
 #include <atomic>
@@ -69,7 +85,11 @@
 #include <cstring>
 #include <map>
 #include <chrono>
+#include <future>
 #include <iostream>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
 
 #ifndef _WIN32
     #include <unistd.h>
@@ -77,211 +97,564 @@
 
 namespace valkyrie {
 
-std::deque<ipc_message> g_ipc_queue;
-std::mutex g_ipc_mutex;
+mpsc_ring<ipc_message> g_ipc_queue(IPC_QUEUE_CAPACITY);
+static std::atomic<size_t> g_ipc_batch_limit{IPC_DEFAULT_BATCH_LIMIT};
 static uv_async_t g_async_handle;
+static uv_async_t g_stop_handle;
+static uv_async_t g_task_handle;
 webview::webview* g_webview_ptr = nullptr;
 static JSContext* g_ctx = nullptr;
 
-static JSValue js_require(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-    const char* module_name = JS_ToCString(ctx, argv[0]);
-    if (!module_name) return JS_EXCEPTION;
+static JSValue js_native_print(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc > 0) {
+        const char* str = JS_ToCString(ctx, argv[0]);
+        if (str) {
+            std::cout << "[JS] " << str << std::endl;
+            JS_FreeCString(ctx, str);
+        }
+    }
+    return JS_UNDEFINED;
+}
+
+// sendToUI(event, data, priority): queued for the next frame flush unless
+// `priority` is set, in which case it and everything before it go out now
+static JSValue js_send_to_ui(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc < 2) return JS_FALSE;
     
-    std::string path = module_name;
+    size_t data_len = 0;
+    const char* event = JS_ToCString(ctx, argv[0]);
+    const char* data = JS_ToCStringLen(ctx, &data_len, argv[1]);
+    bool priority = argc > 2 && JS_ToBool(ctx, argv[2]);
+    trace_span span("sendToUI", "ipc", g_trace.enabled() && event ? trace_recorder::arg("event", event) : "");
     
-    if (path == "http" || path == "https") {
-        JSValue exports = JS_NewObject(ctx);
-        JS_SetPropertyStr(ctx, exports, "fetch", JS_NewCFunction(ctx, js_http_fetch, "fetch", 1));
-        JS_FreeCString(ctx, module_name);
-        return exports;
+    if (event && data) {
+        g_ui_batch.enqueue(event, data, data_len, false, priority);
     }
     
-    auto file = vfs::instance().read_file(path);
+    if (event) JS_FreeCString(ctx, event);
+    if (data) JS_FreeCString(ctx, data);
     
-    if (!file && path.find('.') == std::string::npos) {
-        file = vfs::instance().read_file(path + ".js");
-    }
+    return JS_TRUE;
+}
+
+// sendBinaryToUI(event, ArrayBuffer | TypedArray, priority): the bytes travel as
+// base64, which needs no escaping, and arrive at window[event] as an ArrayBuffer
+static JSValue js_send_binary_to_ui(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc < 2) return JS_FALSE;
     
-    if (!file) {
-        JS_FreeCString(ctx, module_name);
-        return JS_ThrowReferenceError(ctx, "Module not found: %s", module_name);
+    size_t offset = 0, length = 0, element = 0;
+    const uint8_t* bytes = nullptr;
+    JSValue typed_buffer = JS_GetTypedArrayBuffer(ctx, argv[1], &offset, &length, &element);
+    if (JS_IsException(typed_buffer)) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        bytes = JS_GetArrayBuffer(ctx, &length, argv[1]);
+    } else {
+        size_t size = 0;
+        uint8_t* base = JS_GetArrayBuffer(ctx, &size, typed_buffer);
+        bytes = base ? base + offset : nullptr;
+    }
+    // QuickJS hands out a pointer even for empty buffers, so null always means
+    // an exception is pending (not a buffer, or detached)
+    if (!bytes) {
+        JS_FreeValue(ctx, typed_buffer);
+        return JS_EXCEPTION;
     }
     
-    JSValue module_obj = JS_NewObject(ctx);
-    JSValue exports_obj = JS_NewObject(ctx);
-    JS_SetPropertyStr(ctx, module_obj, "exports", exports_obj);
-    
-    JSValue global = JS_GetGlobalObject(ctx);
-    JSValue old_module = JS_GetPropertyStr(ctx, global, "module");
-    JSValue old_exports = JS_GetPropertyStr(ctx, global, "exports");
+    const char* event = JS_ToCString(ctx, argv[0]);
+    if (!event) {
+        JS_FreeValue(ctx, typed_buffer);
+        return JS_EXCEPTION;
+    }
+    bool priority = argc > 2 && JS_ToBool(ctx, argv[2]);
     
-    JS_SetPropertyStr(ctx, global, "module", JS_DupValue(ctx, module_obj));
-    JS_SetPropertyStr(ctx, global, "exports", JS_DupValue(ctx, exports_obj));
+    trace_span span("sendBinaryToUI", "ipc", g_trace.enabled() ? trace_recorder::arg("bytes", length) : "");
+    std::string encoded = base64_encode(bytes, length);
+    g_ui_batch.enqueue(event, encoded.data(), encoded.size(), true, priority);
     
-    std::string code((char*)file->data.data(), file->data.size());
-    JSValue result = JS_Eval(ctx, code.c_str(), code.size(), module_name, JS_EVAL_TYPE_GLOBAL);
+    JS_FreeCString(ctx, event);
+    JS_FreeValue(ctx, typed_buffer);
+    return JS_TRUE;
+}
+
+static void free_ipc_bytes(JSRuntime* rt, void* opaque, void* ptr) {
+    delete (std::vector<uint8_t>*)opaque;
+}
+
+// hands the decoded bytes to handleBinary(channel, ArrayBuffer) without a copy
+static void dispatch_binary_message(ipc_message& msg) {
+    JSValue global = JS_GetGlobalObject(g_ctx);
+    JSValue handler = JS_GetPropertyStr(g_ctx, global, "handleBinary");
     
-    JS_SetPropertyStr(ctx, global, "module", old_module);
-    JS_SetPropertyStr(ctx, global, "exports", old_exports);
-    JS_FreeValue(ctx, global);
+    // the channel arrives as the JSON string literal from the webview's argument array
+    JSValue channel = JS_ParseJSON(g_ctx, msg.data.c_str(), msg.data.length(), "<ipc>");
+    if (!JS_IsString(channel)) {
+        if (JS_IsException(channel)) take_exception_message(g_ctx);
+        std::cerr << "Backend error: invalid sendBinary channel " << msg.data << std::endl;
+        JS_FreeValue(g_ctx, channel);
+        JS_FreeValue(g_ctx, handler);
+        JS_FreeValue(g_ctx, global);
+        return;
+    }
     
-    if (JS_IsException(result)) {
-        JS_FreeValue(ctx, module_obj);
-        JS_FreeCString(ctx, module_name);
-        return result;
+    if (JS_IsFunction(g_ctx, handler)) {
+        auto* owned = new std::vector<uint8_t>(std::move(msg.binary));
+        JSValue args[2] = {
+            JS_DupValue(g_ctx, channel),
+            JS_NewArrayBuffer(g_ctx, owned->data(), owned->size(), free_ipc_bytes, owned, 0),
+        };
+        JSValue result = JS_Call(g_ctx, handler, global, 2, args);
+        if (JS_IsException(result)) {
+            std::cerr << "Backend error: " << take_exception_message(g_ctx) << std::endl;
+        }
+        JS_FreeValue(g_ctx, result);
+        JS_FreeValue(g_ctx, args[0]);
+        JS_FreeValue(g_ctx, args[1]);
     }
     
-    JS_FreeValue(ctx, result);
+    JS_FreeValue(g_ctx, channel);
+    JS_FreeValue(g_ctx, handler);
+    JS_FreeValue(g_ctx, global);
+}
+
+// settles a valkyrie.invoke() promise in the webview; `json` must be a JSON value
+static JSValue js_native_reply(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    if (argc < 3) return JS_FALSE;
+    
+    const char* id = JS_ToCString(ctx, argv[0]);
+    int32_t status = 0;
+    JS_ToInt32(ctx, &status, argv[1]);
+    const char* json = JS_ToCString(ctx, argv[2]);
     
-    JSValue ret = JS_GetPropertyStr(ctx, module_obj, "exports");
-    JS_FreeValue(ctx, module_obj);
-    JS_FreeCString(ctx, module_name);
+    if (id && json && g_webview_ptr) {
+        // sendToUI messages queued before the reply must reach the page first;
+        // both go through webview dispatch, so flushing here keeps them in order
+        g_ui_batch.flush();
+        g_webview_ptr->resolve(id, status, json);
+    }
     
-    return ret;
+    if (id) JS_FreeCString(ctx, id);
+    if (json) JS_FreeCString(ctx, json);
+    return JS_TRUE;
 }
 
-static JSValue js_native_print(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-    if (argc > 0) {
-        const char* str = JS_ToCString(ctx, argv[0]);
-        if (str) {
-            std::cout << "[JS] " << str << std::endl;
-            JS_FreeCString(ctx, str);
+// invoke messages go through __valkyrie_invoke (RUNTIME_JS), which awaits the
+// handleCommand result and replies with native_reply
+static void dispatch_ipc_message(ipc_message& msg) {
+    trace_span span(msg.is_binary ? "handleBinary" : "handleCommand", "ipc");
+    if (g_trace.enabled()) g_trace.flow_end("ipc", msg.timestamp);
+    if (msg.is_binary) {
+        dispatch_binary_message(msg);
+        return;
+    }
+    
+    bool invoke = !msg.reply_id.empty();
+    JSValue global = JS_GetGlobalObject(g_ctx);
+    JSValue handleCmd = JS_GetPropertyStr(g_ctx, global, invoke ? "__valkyrie_invoke" : "handleCommand");
+    
+    if (JS_IsFunction(g_ctx, handleCmd)) {
+        JSValue obj = JS_ParseJSON(g_ctx, msg.data.c_str(), msg.data.length(), "<ipc>");
+        if (!JS_IsException(obj)) {
+            JSValue result;
+            if (invoke) {
+                JSValue args[2] = {JS_NewStringLen(g_ctx, msg.reply_id.data(), msg.reply_id.size()), obj};
+                result = JS_Call(g_ctx, handleCmd, global, 2, args);
+                JS_FreeValue(g_ctx, args[0]);
+            } else {
+                result = JS_Call(g_ctx, handleCmd, global, 1, &obj);
+            }
+            if (JS_IsException(result)) {
+                std::cerr << "Backend error: " << take_exception_message(g_ctx) << std::endl;
+            }
+            JS_FreeValue(g_ctx, result);
+        } else if (invoke && g_webview_ptr) {
+            g_webview_ptr->resolve(msg.reply_id, 1, "\"invalid invoke payload\"");
         }
+        JS_FreeValue(g_ctx, obj);
     }
-    return JS_UNDEFINED;
+    
+    JS_FreeValue(g_ctx, handleCmd);
+    JS_FreeValue(g_ctx, global);
 }
 
-static JSValue js_send_to_ui(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
-    if (argc < 2) return JS_FALSE;
+// uv_async_send calls coalesce, so drain everything that is queued rather than
+// one message per wakeup. the batch limit keeps a burst from starving timers:
+// leftovers re-arm the handle and are picked up on the next loop iteration.
+static void async_cb(uv_async_t* handle) {
+    trace_span span("async_cb", "ipc");
+    size_t limit = g_ipc_batch_limit.load(std::memory_order_relaxed);
+    size_t handled = 0;
+    ipc_message msg;
     
-    const char* event = JS_ToCString(ctx, argv[0]);
-    const char* data = JS_ToCString(ctx, argv[1]);
-    
-    if (event && data && g_webview_ptr) {
-        std::string evt(event);
-        std::string json(data);
-        
-        std::string escaped;
-        for (char c : json) {
-            if (c == '\\') escaped += "\\\\";
-            else if (c == '\'') escaped += "\\'";
-            else if (c == '\n') escaped += "\\n";
-            else if (c == '\r') escaped += "\\r";
-            else if (c == '\t') escaped += "\\t";
-            else escaped += c;
+    while (handled < limit && g_ipc_queue.try_pop(msg)) {
+        if (g_ctx) {
+            record_ipc_wait(msg.timestamp);
+            metrics_scope scope(metric_category::ipc);
+            dispatch_ipc_message(msg);
+            run_microtasks(g_ctx);
         }
-        
-        std::string js = "if(window." + evt + "){window." + evt + "('" + escaped + "');}";
-        
-        g_webview_ptr->dispatch([js]() {
+        handled++;
+    }
+    
+    if (!g_ipc_queue.empty()) {
+        uv_async_send(handle);
+    }
+}
+
+static void stop_cb(uv_async_t* handle) {
+    uv_stop(handle->loop);
+}
+
+// work posted to the logic thread. QuickJS contexts are single-threaded, so
+// anything that touches the context from another thread goes through here.
+using logic_task = std::function<void(JSContext*)>;
+
+constexpr size_t TASK_QUEUE_CAPACITY = 1024;
+mpsc_ring<logic_task> g_task_queue(TASK_QUEUE_CAPACITY);
+
+static void drain_tasks(size_t limit) {
+    logic_task task;
+    size_t handled = 0;
+    while (handled < limit && g_task_queue.try_pop(task)) {
+        metrics_scope scope(metric_category::task);
+        task(g_ctx);
+        task = nullptr;
+        run_microtasks(g_ctx);
+        handled++;
+    }
+}
+
+static void task_cb(uv_async_t* handle) {
+    drain_tasks(g_ipc_batch_limit.load(std::memory_order_relaxed));
+    if (!g_task_queue.empty()) {
+        uv_async_send(handle);
+    }
+}
+
+static void report_script_error(const std::string& err) {
+    if (g_webview_ptr) {
+        std::string msg = "JS Error: " + err;
+        g_webview_ptr->dispatch([msg]() {
             if (g_webview_ptr) {
-                g_webview_ptr->eval(js);
+                g_webview_ptr->eval("console.error('" + msg + "');");
             }
         });
     }
-    
-    if (event) JS_FreeCString(ctx, event);
-    if (data) JS_FreeCString(ctx, data);
-    
-    return JS_TRUE;
 }
 
-static void async_cb(uv_async_t* handle) {
-    ipc_message msg;
-    {
-        std::lock_guard<std::mutex> lock(g_ipc_mutex);
-        if (!g_ipc_queue.empty()) {
-            msg = g_ipc_queue.front();
-            g_ipc_queue.pop_front();
-        } else {
-            return;
+static void report_eval_result(JSContext* ctx, JSValue result, bool is_module) {
+    if (JS_IsException(result)) {
+        report_script_error(take_exception_message(ctx));
+    } else if (is_module && JS_IsObject(result)) {
+        // module evaluation yields a promise (top-level await); surface rejections
+        run_microtasks(ctx);
+        if (JS_PromiseState(ctx, result) == JS_PROMISE_REJECTED) {
+            JSValue reason = JS_PromiseResult(ctx, result);
+            const char* err = JS_ToCString(ctx, reason);
+            report_script_error(err ? err : "module evaluation failed");
+            if (err) JS_FreeCString(ctx, err);
+            JS_FreeValue(ctx, reason);
         }
     }
-    
-    if (g_ctx) {
-        JSValue global = JS_GetGlobalObject(g_ctx);
-        JSValue handleCmd = JS_GetPropertyStr(g_ctx, global, "handleCommand");
-        
-        if (JS_IsFunction(g_ctx, handleCmd)) {
-            JSValue obj = JS_ParseJSON(g_ctx, msg.data.c_str(), msg.data.length(), "<ipc>");
-            if (!JS_IsException(obj)) {
-                JSValue result = JS_Call(g_ctx, handleCmd, global, 1, &obj);
-                if (JS_IsException(result)) {
-                    JSValue exception = JS_GetException(g_ctx);
-                    const char* err = JS_ToCString(g_ctx, exception);
-                    if (err) {
-                        std::cerr << "Backend error: " << err << std::endl;
-                        JS_FreeCString(g_ctx, err);
-                    }
-                    JS_FreeValue(g_ctx, exception);
-                }
-                JS_FreeValue(g_ctx, result);
-            }
-            JS_FreeValue(g_ctx, obj);
+    JS_FreeValue(ctx, result);
+}
+
+// `code` must be NUL-terminated at code[size()]
+static void eval_and_report(JSContext* ctx, std::string_view code, const std::string& filename, int flags = JS_EVAL_TYPE_GLOBAL) {
+    trace_span span("JS_Eval", "eval", g_trace.enabled() ? trace_recorder::arg("file", filename) : "");
+    JSValue result = JS_Eval(ctx, code.data(), code.size(), filename.c_str(), flags);
+    report_eval_result(ctx, result, (flags & JS_EVAL_TYPE_MODULE) != 0);
+}
+
+static void eval_bytecode_and_report(JSContext* ctx, const std::string& id, const vfs::file_entry& file, bool is_module) {
+    trace_span span("JS_EvalFunction", "eval", g_trace.enabled() ? trace_recorder::arg("bytes", file.data.size()) : "");
+    JSValue func = read_packed_bytecode(ctx, id, file, is_module ? JS_EVAL_TYPE_MODULE : JS_EVAL_TYPE_GLOBAL);
+    if (!JS_IsException(func) && is_module && JS_ResolveModule(ctx, func) < 0) {
+        JS_FreeValue(ctx, func);
+        func = JS_EXCEPTION;
+    }
+    if (JS_IsException(func)) {
+        report_eval_result(ctx, func, is_module);
+        return;
+    }
+    report_eval_result(ctx, JS_EvalFunction(ctx, func), is_module);
+}
+
+// prefers the bytecode baked in at build time and falls back to parsing the
+// source when it is stale (runtime.hpp changed) or from another QuickJS version
+static JSValue eval_runtime_js(JSContext* ctx) {
+#ifdef VALKYRIE_HAS_RUNTIME_BYTECODE
+    if (RUNTIME_BYTECODE_SOURCE_HASH == fnv1a_hash(RUNTIME_JS, strlen(RUNTIME_JS))) {
+        JSValue func = read_bytecode(ctx, RUNTIME_BYTECODE, RUNTIME_BYTECODE_SIZE);
+        if (!JS_IsException(func)) {
+            return JS_EvalFunction(ctx, func);
         }
-        
-        JS_FreeValue(g_ctx, handleCmd);
-        JS_FreeValue(g_ctx, global);
+        JS_FreeValue(ctx, JS_GetException(ctx));
     }
+#endif
+    return JS_Eval(ctx, RUNTIME_JS, strlen(RUNTIME_JS), "<runtime>", JS_EVAL_TYPE_GLOBAL);
 }
 
+// QuickJS heap settings; zero keeps the QuickJS default for that knob
+struct runtime_options {
+    size_t memory_limit = 0;
+    size_t gc_threshold = 0;
+    size_t max_stack_size = 0;
+    // sampling profiler output; empty falls back to $VALKYRIE_PROFILE
+    std::string profile_path;
+    uint64_t profile_interval_us = 0;
+    // Chrome trace_event output; empty falls back to $VALKYRIE_TRACE
+    std::string trace_path;
+    // sendToUI messages are flushed to the webview once per interval; 0 sends each immediately
+    uint64_t ui_batch_interval_ms = UI_BATCH_DEFAULT_INTERVAL_MS;
+    // macrotasks running JS longer than this are reported; 0 disables the watchdog
+    uint64_t long_task_budget_ms = 0;
+    bool abort_long_tasks = false;
+    // replaces the default long-task report to the UI; runs on the logic thread
+    std::function<void(const long_task_report&)> on_long_task;
+    // replaces the default out-of-memory report to the UI; runs on the logic thread
+    std::function<void()> on_out_of_memory;
+};
+
+static void report_out_of_memory(size_t limit) {
+    std::cerr << "Backend out of memory (limit " << limit << " bytes)" << std::endl;
+    if (g_webview_ptr) {
+        std::string js = "console.error('Backend out of memory');"
+                         "if(window.onOutOfMemory){window.onOutOfMemory(" + std::to_string(limit) + ");}";
+        g_webview_ptr->dispatch([js]() {
+            if (g_webview_ptr) g_webview_ptr->eval(js);
+        });
+    }
+}
+
+static void report_long_task(const long_task_report& report) {
+    if (!g_webview_ptr) return;
+    std::string js = "console.warn('Backend " + std::string(report.category) + " task exceeded " +
+                     std::to_string((int)report.budget_ms) + " ms');"
+                     "if(window.onLongTask){window.onLongTask(" + report.to_json() + ");}";
+    g_webview_ptr->dispatch([js]() {
+        if (g_webview_ptr) g_webview_ptr->eval(js);
+    });
+}
+
+// installed with webview init() so it runs before page scripts on every load
+static const char* VALKYRIE_API_JS = R"api(
+window.valkyrie = {
+    send(data) {
+        window.native_send(JSON.stringify(data));
+    },
+    invoke(command, payload) {
+        return window.native_invoke({ command: command, data: payload });
+    },
+    sendBinary(channel, data) {
+        const bytes = data instanceof ArrayBuffer
+            ? new Uint8Array(data)
+            : new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+        let binary = '';
+        for (let i = 0; i < bytes.length; i += 0x8000) {
+            binary += String.fromCharCode.apply(null, bytes.subarray(i, i + 0x8000));
+        }
+        return window.native_send_binary(String(channel), btoa(binary));
+    },
+    dialog: {
+        showMessageBox(options) {
+            const title = options.title || 'Message';
+            const message = options.message || '';
+            window.native_send(JSON.stringify({
+                command: 'dialog',
+                message: title + '\\n\\n' + message
+            }));
+        },
+        showOpenDialog(options) {
+            window.native_send(JSON.stringify({ command: 'open_file' }));
+        },
+        showSaveDialog(options) {
+            window.native_send(JSON.stringify({ command: 'save_file' }));
+        }
+    },
+    notification: {
+        show(title, body) {
+            window.native_send(JSON.stringify({
+                command: 'notify',
+                message: title + ': ' + body
+            }));
+        }
+    },
+    clipboard: {
+        writeText(text) {
+            window.native_send(JSON.stringify({
+                command: 'clipboard_write',
+                text: text
+            }));
+        },
+        readText() {
+            window.native_send(JSON.stringify({ command: 'clipboard_read' }));
+        }
+    },
+    window: {
+        setTitle(title) {
+            document.title = title;
+        }
+    },
+    version: '1.0.0',
+    platform: 'linux'
+};
+window.open = function(url) {
+    window.native_send(JSON.stringify({ command: 'open_url', url: url }));
+};
+console.log('Valkyrie API loaded');
+)api";
+
 class app {
 public:
-    app() : running_(false), rt_(nullptr), ctx_(nullptr) {}
+    explicit app(runtime_options options = {})
+        : running_(false), stop_requested_(false), loop_ready_(false), options_(std::move(options)),
+          rt_(nullptr), ctx_(nullptr) {}
     
     ~app() {
         stop();
     }
     
+    // returns once the logic thread has a usable context with RUNTIME_JS loaded
     void init() {
+        g_trace.start(options_.trace_path.empty() ? trace_path_from_env() : options_.trace_path);
         stop_requested_.store(false);
+        init_start_ = std::chrono::steady_clock::now();
+        html_timed_ = false;
+        
+        ready_ = std::promise<void>();
+        std::future<void> ready = ready_.get_future();
+        
         logic_thread_ = std::thread([this]() {
             this->logic_thread_main();
         });
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ready.wait();
     }
     
+    // runs on the logic thread; blocks the caller until the script has been evaluated
     void load_script(const std::string& code, const std::string& filename = "<eval>") {
-        int retries = 50;
-        while (!ctx_ && retries-- > 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
-        
-        if (!ctx_) return;
-        
-        JSValue result = JS_Eval(ctx_, code.c_str(), code.size(), filename.c_str(), JS_EVAL_TYPE_GLOBAL);
-        if (JS_IsException(result)) {
-            JSValue exception = JS_GetException(ctx_);
-            const char* err = JS_ToCString(ctx_, exception);
-            if (err) {
-                if (g_webview_ptr) {
-                    std::string msg = "JS Error: " + std::string(err);
-                    g_webview_ptr->dispatch([msg]() {
-                        if (g_webview_ptr) {
-                            g_webview_ptr->eval("console.error('" + msg + "');");
-                        }
-                    });
-                }
-                JS_FreeCString(ctx_, err);
-            }
-            JS_FreeValue(ctx_, exception);
-        }
-        JS_FreeValue(ctx_, result);
+        run_blocking([&code, &filename](JSContext* ctx) {
+            eval_and_report(ctx, code, filename);
+        });
+    }
+    
+    // evaluates `code` as an ES module; relative imports resolve against `filename` in the vfs
+    void load_module(const std::string& code, const std::string& filename) {
+        run_blocking([&code, &filename](JSContext* ctx) {
+            eval_and_report(ctx, code, filename, JS_EVAL_TYPE_MODULE);
+        });
     }
     
+    // accepts source (script or module) and entries precompiled by `valkyrie build --bytecode`
     void load_from_vfs(const std::string& path) {
         auto file = vfs::instance().read_file(path);
         if (!file) return;
         
-        std::string code((char*)file->data.data(), file->data.size());
-        load_script(code, path);
+        std::string id = (!path.empty() && path[0] == '/') ? path.substr(1) : path;
+        if (file->mime_type == SCRIPT_BYTECODE_MIME || file->mime_type == MODULE_BYTECODE_MIME) {
+            bool is_module = file->mime_type == MODULE_BYTECODE_MIME;
+            run_blocking([&file, &id, is_module](JSContext* ctx) {
+                eval_bytecode_and_report(ctx, id, *file, is_module);
+            });
+            return;
+        }
+        
+        // evaluated straight from vfs storage; the entry keeps it alive until run_blocking returns
+        std::string_view code = file->text();
+        bool is_module = is_module_source(id, code);
+        const std::string& filename = is_module ? id : path;
+        run_blocking([code, &filename, is_module](JSContext* ctx) {
+            eval_and_report(ctx, code, filename, is_module ? JS_EVAL_TYPE_MODULE : JS_EVAL_TYPE_GLOBAL);
+        });
     }
     
     void eval(const std::string& code) {
         load_script(code, "<eval>");
     }
     
+    // evaluates on the logic thread without blocking the caller. the future holds
+    // the stringified completion value, or a std::runtime_error with the JS error.
+    std::future<std::string> eval_async(std::string code, std::string filename = "<eval>") {
+        auto result = std::make_shared<std::promise<std::string>>();
+        std::future<std::string> future = result->get_future();
+        
+        bool posted = post([result, code = std::move(code), filename = std::move(filename)](JSContext* ctx) {
+            JSValue value = JS_Eval(ctx, code.c_str(), code.size(), filename.c_str(), JS_EVAL_TYPE_GLOBAL);
+            if (JS_IsException(value)) {
+                result->set_exception(std::make_exception_ptr(std::runtime_error(take_exception_message(ctx))));
+                return;
+            }
+            const char* str = JS_ToCString(ctx, value);
+            result->set_value(str ? str : "");
+            if (str) JS_FreeCString(ctx, str);
+            JS_FreeValue(ctx, value);
+        });
+        
+        if (!posted) {
+            result->set_exception(std::make_exception_ptr(std::runtime_error("runtime is not running")));
+        }
+        return future;
+    }
+    
+    // delivers `json` to the backend's handleCommand exactly like native_send;
+    // callable from any thread once init() has returned. builtin commands open
+    // dialogs and touch the clipboard, so off the UI thread they go through dispatch.
+    void send(std::string json) {
+        trace_span span("native_send", "ipc");
+        if (g_webview_ptr && std::this_thread::get_id() != ui_thread_id_) {
+            g_webview_ptr->dispatch([json]() {
+                handle_builtin_command(json);
+            });
+        } else {
+            handle_builtin_command(json);
+        }
+        
+        enqueue_ipc(ipc_message{std::move(json), uv_hrtime(), {}});
+    }
+    
+    // queues a closure for the logic thread. returns false once the loop has shut down.
+    bool post(logic_task task) {
+        loop_users_.fetch_add(1);
+        if (!loop_ready_.load()) {
+            loop_users_.fetch_sub(1);
+            return false;
+        }
+        
+        while (!g_task_queue.try_push(std::move(task))) {
+            if (on_logic_thread()) {
+                // we are the consumer, waiting would never finish
+                task(ctx_);
+                loop_users_.fetch_sub(1);
+                return true;
+            }
+            uv_async_send(&g_task_handle);
+            std::this_thread::yield();
+        }
+        uv_async_send(&g_task_handle);
+        loop_users_.fetch_sub(1);
+        return true;
+    }
+    
+    // max promise jobs drained after each macrotask before yielding back to the loop
+    void set_microtask_budget(size_t budget) {
+        g_microtask_budget.store(budget > 0 ? budget : 1);
+    }
+    
+    // logic-thread counters; read from elsewhere they are only approximate
+    const microtask_stats& job_stats() const { return g_microtask_stats; }
+    
+    // pool allocator counters, read on the logic thread that owns the pools
+    allocator_stats allocation_stats() {
+        allocator_stats stats;
+        run_blocking([&stats](JSContext*) { stats = pool_allocator_stats(); });
+        return stats;
+    }
+    
+    // max IPC messages dispatched per wakeup before yielding to timers and I/O
+    void set_ipc_batch_limit(size_t limit) {
+        g_ipc_batch_limit.store(limit > 0 ? limit : 1);
+    }
+    
     webview::webview& webview() { return *webview_; }
     
     void run(const std::string& title = "Valkyrie App", int width = 1280, int height = 720) {
@@ -292,10 +665,17 @@ public:
         
         webview_ = std::make_unique<webview::webview>(true, nullptr);
         g_webview_ptr = webview_.get();
+        ui_thread_id_ = std::this_thread::get_id();
+        if (g_trace.enabled()) g_trace.name_thread("ui");
         
         webview_->set_title(title);
         webview_->set_size(width, height, WEBVIEW_HINT_NONE);
         
+#ifdef VALKYRIE_HAS_APP_SCHEME
+        register_app_scheme(native_web_view());
+#endif
+        webview_->init(VALKYRIE_API_JS);
+        webview_->init(UI_BATCH_DISPATCHER);
         webview_->init(R"js(
             document.addEventListener('click', function(e) {
                 let el = e.target;
@@ -308,8 +688,12 @@ public:
             }, true);
         )js");
         
-        if (!pending_html_.empty()) {
+        if (!pending_url_.empty()) {
+            webview_->navigate(pending_url_);
+            report_first_html();
+        } else if (!pending_html_.empty()) {
             webview_->set_html(pending_html_);
+            report_first_html();
         }
         
         webview_->bind("native_send", [this](std::string req) -> std::string {
@@ -339,18 +723,47 @@ public:
                 }
             }
             
-            handle_builtin_command(json_str);
-            
-            {
-                std::lock_guard<std::mutex> lock(g_ipc_mutex);
-                g_ipc_queue.push_back({json_str, 0});
+            send(std::move(json_str));
+            return "{}";
+        });
+        
+        // valkyrie.invoke(): the JS promise stays pending until the backend
+        // replies through native_reply with this call's id
+        webview_->bind("native_invoke", [this](std::string id, std::string req, void*) {
+            trace_span span("native_invoke", "ipc");
+            // req is the JSON argument array; the single argument is the message object
+            std::string json_str = req.size() > 2 ? req.substr(1, req.size() - 2) : "{}";
+            enqueue_ipc(ipc_message{std::move(json_str), uv_hrtime(), std::move(id)});
+        }, nullptr);
+        
+        // args are ["channel", "<base64>"]; base64 never contains quotes or
+        // escapes, so the payload is sliced out without an unescape pass. the
+        // channel keeps its quotes and escapes and is JSON-parsed on the logic thread
+        webview_->bind("native_send_binary", [this](std::string req) -> std::string {
+            trace_span span("native_send_binary", "ipc");
+            size_t payload_end = req.rfind('"');
+            size_t payload_start = payload_end == std::string::npos ? std::string::npos : req.rfind('"', payload_end - 1);
+            size_t channel_start = req.find('"');
+            if (payload_start == std::string::npos || channel_start == std::string::npos || channel_start >= payload_start) {
+                return "false";
+            }
+            size_t channel_end = req.rfind('"', payload_start - 1);
+            if (channel_end == std::string::npos || channel_end <= channel_start) {
+                return "false";
             }
-            uv_async_send(&g_async_handle);
             
-            return "{}";
+            ipc_message msg;
+            msg.data = req.substr(channel_start, channel_end - channel_start + 1);
+            msg.timestamp = uv_hrtime();
+            msg.is_binary = true;
+            if (!base64_decode(req.data() + payload_start + 1, payload_end - payload_start - 1, msg.binary)) {
+                return "false";
+            }
+            enqueue_ipc(std::move(msg));
+            return "true";
         });
         
-        if (pending_html_.empty()) {
+        if (pending_html_.empty() && pending_url_.empty()) {
             const char* default_html = R"html(
 <!DOCTYPE html>
 <html>
@@ -372,118 +785,203 @@ public:
 </html>
             )html";
             webview_->set_html(default_html);
+            report_first_html();
         }
         
         running_ = true;
         webview_->run();
         running_ = false;
+        wake_logic_thread();
     }
     
     void set_html(const std::string& html) {
-        std::string injected_html = html;
-        
-        const char* valkyrie_api = R"api(
-<script>
-window.valkyrie = {
-    send(data) {
-        window.native_send(JSON.stringify(data));
-    },
-    dialog: {
-        showMessageBox(options) {
-            const title = options.title || 'Message';
-            const message = options.message || '';
-            window.native_send(JSON.stringify({
-                command: 'dialog',
-                message: title + '\\n\\n' + message
-            }));
-        },
-        showOpenDialog(options) {
-            window.native_send(JSON.stringify({ command: 'open_file' }));
-        },
-        showSaveDialog(options) {
-            window.native_send(JSON.stringify({ command: 'save_file' }));
-        }
-    },
-    notification: {
-        show(title, body) {
-            window.native_send(JSON.stringify({
-                command: 'notify',
-                message: title + ': ' + body
-            }));
-        }
-    },
-    clipboard: {
-        writeText(text) {
-            window.native_send(JSON.stringify({
-                command: 'clipboard_write',
-                text: text
-            }));
-        },
-        readText() {
-            window.native_send(JSON.stringify({ command: 'clipboard_read' }));
-        }
-    },
-    window: {
-        setTitle(title) {
-            document.title = title;
-        }
-    },
-    version: '1.0.0',
-    platform: 'linux'
-};
-window.open = function(url) {
-    window.native_send(JSON.stringify({ command: 'open_url', url: url }));
-};
-console.log('Valkyrie API loaded');
-</script>
-)api";
-        
-        size_t head_pos = injected_html.find("</head>");
-        if (head_pos != std::string::npos) {
-            injected_html.insert(head_pos, valkyrie_api);
-        } else {
-            size_t body_pos = injected_html.find("<body>");
-            if (body_pos != std::string::npos) {
-                injected_html.insert(body_pos, valkyrie_api);
-            }
+        pending_url_.clear();
+        pending_html_ = html;
+        if (webview_) {
+            webview_->set_html(pending_html_);
+            report_first_html();
         }
-        
-        pending_html_ = injected_html;
+    }
+    
+    // shows a page stored in the vfs under APP_ASSET_ROOT; with a valkyrie://
+    // scheme the HTML only references its assets and WebKit fetches, streams
+    // and caches them itself
+    void load_page(const std::string& page_path) {
+#ifdef VALKYRIE_HAS_APP_SCHEME
+        pending_html_.clear();
+        pending_url_ = APP_ORIGIN + page_path;
         if (webview_) {
-            webview_->set_html(injected_html);
+            webview_->navigate(pending_url_);
+            report_first_html();
         }
+#else
+        auto page = vfs::instance().read_file(APP_ASSET_ROOT + page_path);
+        if (!page) {
+            std::cerr << "[valkyrie] page not found in vfs: " << APP_ASSET_ROOT << page_path << std::endl;
+            return;
+        }
+        set_html(inline_vfs_assets(std::string(page->text())));
+#endif
     }
     
     void stop() {
         running_ = false;
         stop_requested_.store(true);
+        wake_logic_thread();
         if (logic_thread_.joinable()) {
             logic_thread_.join();
         }
-        if (ctx_) {
-            JS_RunGC(rt_);
-            JS_FreeContext(ctx_);
-            ctx_ = nullptr;
-        }
-        if (rt_) {
-            JS_RunGC(rt_);
-            JS_FreeRuntime(rt_);
-            rt_ = nullptr;
-        }
+        // the logic thread already freed them; its allocator pools died with it
+        ctx_ = nullptr;
+        rt_ = nullptr;
+        g_trace.stop();
     }
 
 private:
+    void enqueue_ipc(ipc_message&& msg) {
+        if (g_trace.enabled()) g_trace.flow_start("ipc", msg.timestamp);
+        while (!g_ipc_queue.try_push(std::move(msg))) {
+            // ring is full: make sure the logic thread is draining and back off
+            if (!signal_loop(&g_async_handle)) {
+                if (!msg.reply_id.empty() && g_webview_ptr) {
+                    g_webview_ptr->resolve(msg.reply_id, 1, "\"backend stopped\"");
+                }
+                return;
+            }
+            std::this_thread::yield();
+        }
+        signal_loop(&g_async_handle);
+    }
+    
+    // the caller waits for completion, so the task may capture locals by reference
+    void run_blocking(const logic_task& task) {
+        if (!ctx_) return;
+        
+        if (on_logic_thread()) {
+            task(ctx_);
+            return;
+        }
+        
+        auto done = std::make_shared<std::promise<void>>();
+        std::future<void> finished = done->get_future();
+        bool posted = post([done, &task](JSContext* ctx) {
+            task(ctx);
+            done->set_value();
+        });
+        if (posted) {
+            finished.wait();
+        }
+    }
+    
+    // the logic thread blocks in uv_run until g_stop_handle fires, so anything
+    // that ends the app has to poke it instead of flipping a flag
+    void wake_logic_thread() {
+        signal_loop(&g_stop_handle);
+    }
+    
+    // uv_async_send is thread-safe but must not race uv_close; the logic thread
+    // waits for in-flight senders to leave before it closes the handles
+    bool signal_loop(uv_async_t* handle) {
+        loop_users_.fetch_add(1);
+        bool ready = loop_ready_.load();
+        if (ready) {
+            uv_async_send(handle);
+        }
+        loop_users_.fetch_sub(1);
+        return ready;
+    }
+    
+    bool on_logic_thread() const {
+        return std::this_thread::get_id() == logic_thread_id_;
+    }
+    
+    static bool startup_timing_enabled() {
+        static const bool enabled = getenv("VALKYRIE_STARTUP_TIMING") != nullptr;
+        return enabled;
+    }
+    
+    static double elapsed_ms(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+    }
+    
+    static void report_startup_phase(const char* phase, double ms) {
+        if (!startup_timing_enabled()) return;
+        std::cerr << "[startup] " << phase << ": " << ms << " ms" << std::endl;
+    }
+    
+#ifdef VALKYRIE_HAS_APP_SCHEME
+    // the WebKitWebView behind the webview; older webview releases return the raw pointer
+    void* native_web_view() {
+        return unwrap_native_handle(webview_->browser_controller());
+    }
+    
+    template <typename T>
+    static void* unwrap_native_handle(T handle) {
+        if constexpr (std::is_pointer_v<T>) {
+            return handle;
+        } else {
+            return handle.ok() ? handle.value() : nullptr;
+        }
+    }
+#endif
+    
+    void report_first_html() {
+        if (html_timed_) return;
+        html_timed_ = true;
+        report_startup_phase("first html set", elapsed_ms(init_start_));
+    }
+    
+    void apply_runtime_options() {
+        if (options_.memory_limit) JS_SetMemoryLimit(rt_, options_.memory_limit);
+        if (options_.gc_threshold) JS_SetGCThreshold(rt_, options_.gc_threshold);
+        if (options_.max_stack_size) JS_SetMaxStackSize(rt_, options_.max_stack_size);
+        
+        g_out_of_memory_handler = [this](JSContext*) {
+            if (options_.on_out_of_memory) {
+                options_.on_out_of_memory();
+            } else {
+                report_out_of_memory(options_.memory_limit);
+            }
+        };
+    }
+    
+    // the profiler and watchdog share the interrupt handler; it is only
+    // installed when one of them is on
+    void start_interrupt_users() {
+        std::string path = options_.profile_path.empty() ? profile_path_from_env() : options_.profile_path;
+        uint64_t interval = options_.profile_interval_us ? options_.profile_interval_us : profile_interval_from_env();
+        g_profiler.start(path, interval);
+        
+        g_watchdog.configure(options_.long_task_budget_ms, options_.abort_long_tasks);
+        g_watchdog.on_long_task = options_.on_long_task ? options_.on_long_task : report_long_task;
+        
+        if (g_profiler.active() || g_watchdog.enabled()) {
+            install_interrupt_handler(rt_, ctx_);
+        }
+    }
+    
     void logic_thread_main() {
         uv_loop_t* loop = uv_default_loop();
         
+        logic_thread_id_ = std::this_thread::get_id();
+        if (g_trace.enabled()) g_trace.name_thread("logic");
         uv_async_init(loop, &g_async_handle, async_cb);
+        uv_async_init(loop, &g_stop_handle, stop_cb);
+        uv_async_init(loop, &g_task_handle, task_cb);
         
-        rt_ = JS_NewRuntime();
+        auto phase_start = std::chrono::steady_clock::now();
+        rt_ = new_js_runtime();
+        apply_runtime_options();
         ctx_ = JS_NewContext(rt_);
         g_ctx = ctx_;
+        install_module_loader(rt_);
+        report_startup_phase("runtime created", elapsed_ms(phase_start));
+        phase_start = std::chrono::steady_clock::now();
         
         JS_NewClassID(&js_socket_class_id);
         JS_NewClass(rt_, js_socket_class_id, &js_socket_class);
+        JS_NewClassID(&js_module_cache_class_id);
+        JS_NewClass(rt_, js_module_cache_class_id, &js_module_cache_class);
         
         JSValue global = JS_GetGlobalObject(ctx_);
         
@@ -500,9 +998,17 @@ private:
         JS_SetPropertyStr(ctx_, global, "NativeSocket", socket_ctor);
         
         JS_SetPropertyStr(ctx_, global, "setTimeout", JS_NewCFunction(ctx_, js_set_timeout, "setTimeout", 2));
-        JS_SetPropertyStr(ctx_, global, "require", JS_NewCFunction(ctx_, js_require, "require", 1));
+        JS_SetPropertyStr(ctx_, global, "setInterval", JS_NewCFunction(ctx_, js_set_interval, "setInterval", 2));
+        JS_SetPropertyStr(ctx_, global, "setImmediate", JS_NewCFunction(ctx_, js_set_immediate, "setImmediate", 1));
+        JS_SetPropertyStr(ctx_, global, "clearTimeout", JS_NewCFunction(ctx_, js_clear_timer, "clearTimeout", 1));
+        JS_SetPropertyStr(ctx_, global, "clearInterval", JS_NewCFunction(ctx_, js_clear_timer, "clearInterval", 1));
+        JS_SetPropertyStr(ctx_, global, "clearImmediate", JS_NewCFunction(ctx_, js_clear_timer, "clearImmediate", 1));
+        JS_SetPropertyStr(ctx_, global, "queueMicrotask", JS_NewCFunction(ctx_, js_queue_microtask, "queueMicrotask", 1));
+        JS_SetPropertyStr(ctx_, global, "require", js_new_require(ctx_));
         JS_SetPropertyStr(ctx_, global, "native_print", JS_NewCFunction(ctx_, js_native_print, "native_print", 1));
         JS_SetPropertyStr(ctx_, global, "sendToUI", JS_NewCFunction(ctx_, js_send_to_ui, "sendToUI", 2));
+        JS_SetPropertyStr(ctx_, global, "native_reply", JS_NewCFunction(ctx_, js_native_reply, "native_reply", 3));
+        JS_SetPropertyStr(ctx_, global, "sendBinaryToUI", JS_NewCFunction(ctx_, js_send_binary_to_ui, "sendBinaryToUI", 2));
         JS_SetPropertyStr(ctx_, global, "buffer_alloc", JS_NewCFunction(ctx_, js_buffer_alloc, "buffer_alloc", 1));
         JS_SetPropertyStr(ctx_, global, "buffer_from_bytes", JS_NewCFunction(ctx_, js_buffer_from_bytes, "buffer_from_bytes", 1));
         
@@ -554,7 +1060,14 @@ private:
         JS_SetPropertyStr(ctx_, cp_obj, "spawn", JS_NewCFunction(ctx_, js_spawn, "spawn", 1));
         JS_SetPropertyStr(ctx_, global, "child_process", cp_obj);
         
-        JSValue runtime_result = JS_Eval(ctx_, RUNTIME_JS, strlen(RUNTIME_JS), "<runtime>", JS_EVAL_TYPE_GLOBAL);
+        JS_SetPropertyStr(ctx_, global, "native_memory_usage", JS_NewCFunction(ctx_, js_memory_usage, "native_memory_usage", 0));
+        JS_SetPropertyStr(ctx_, global, "native_dump_memory", JS_NewCFunction(ctx_, js_dump_memory_usage, "native_dump_memory", 1));
+        JS_SetPropertyStr(ctx_, global, "native_metrics", JS_NewCFunction(ctx_, js_metrics, "native_metrics", 0));
+        JS_SetPropertyStr(ctx_, global, "native_metrics_reset", JS_NewCFunction(ctx_, js_metrics_reset, "native_metrics_reset", 0));
+        report_startup_phase("bindings", elapsed_ms(phase_start));
+        phase_start = std::chrono::steady_clock::now();
+        
+        JSValue runtime_result = eval_runtime_js(ctx_);
         if (JS_IsException(runtime_result)) {
             JSValue exception = JS_GetException(ctx_);
             const char* err = JS_ToCString(ctx_, exception);
@@ -565,23 +1078,63 @@ private:
         }
         JS_FreeValue(ctx_, runtime_result);
         JS_FreeValue(ctx_, global);
+        init_microtask_pump(loop, ctx_);
+        g_timers.init(loop, ctx_);
+        g_ui_batch.init(loop, options_.ui_batch_interval_ms);
+        init_memory_signal(loop, rt_);
+        init_metrics(loop);
+        start_interrupt_users();
+        report_startup_phase("runtime js", elapsed_ms(phase_start));
+        report_startup_phase("ready", elapsed_ms(init_start_));
         
         running_ = true;
-        while (!stop_requested_.load() && running_) {
-            uv_run(loop, UV_RUN_NOWAIT);
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        loop_ready_.store(true);
+        ready_.set_value();
+        
+        if (!stop_requested_.load()) {
+            uv_run(loop, UV_RUN_DEFAULT);
         }
         
+        loop_ready_.store(false);
+        while (loop_users_.load() > 0) {
+            drain_tasks(TASK_QUEUE_CAPACITY);
+            std::this_thread::yield();
+        }
+        drain_tasks(TASK_QUEUE_CAPACITY);
+        
+        g_timers.close();
+        g_ui_batch.close();
+        close_microtask_pump();
+        close_memory_signal();
+        close_metrics();
         uv_close((uv_handle_t*)&g_async_handle, nullptr);
+        uv_close((uv_handle_t*)&g_stop_handle, nullptr);
+        uv_close((uv_handle_t*)&g_task_handle, nullptr);
         uv_run(loop, UV_RUN_DEFAULT);
         uv_loop_close(loop);
+        
+        g_profiler.stop();
+        g_ctx = nullptr;
+        JS_RunGC(rt_);
+        JS_FreeContext(ctx_);
+        JS_RunGC(rt_);
+        JS_FreeRuntime(rt_);
     }
     
     std::thread logic_thread_;
     std::unique_ptr<webview::webview> webview_;
     std::atomic<bool> running_;
     std::atomic<bool> stop_requested_;
+    std::atomic<bool> loop_ready_;
+    std::atomic<int> loop_users_{0};
+    std::thread::id logic_thread_id_;
+    std::thread::id ui_thread_id_;
+    std::promise<void> ready_;
+    std::chrono::steady_clock::time_point init_start_;
+    bool html_timed_ = false;
     std::string pending_html_;
+    std::string pending_url_;
+    runtime_options options_;
     
     JSRuntime* rt_;
     JSContext* ctx_;
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace valkyrie {
+
+// standard alphabet with padding, matching the browser's btoa/atob. the
+// output never needs escaping, which is the point of the binary channel.
+static constexpr char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+struct base64_decode_table {
+    uint8_t value[256];
+    
+    constexpr base64_decode_table() : value() {
+        for (int i = 0; i < 256; i++) value[i] = 0xFF;
+        for (int i = 0; i < 64; i++) value[(uint8_t)BASE64_ALPHABET[i]] = (uint8_t)i;
+    }
+};
+
+static constexpr base64_decode_table base64_lookup;
+
+inline std::string base64_encode(const uint8_t* data, size_t len) {
+    std::string out;
+    out.resize((len + 2) / 3 * 4);
+    char* dst = out.data();
+    
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3) {
+        uint32_t n = (uint32_t)data[i] << 16 | (uint32_t)data[i + 1] << 8 | data[i + 2];
+        *dst++ = BASE64_ALPHABET[n >> 18];
+        *dst++ = BASE64_ALPHABET[(n >> 12) & 63];
+        *dst++ = BASE64_ALPHABET[(n >> 6) & 63];
+        *dst++ = BASE64_ALPHABET[n & 63];
+    }
+    if (i < len) {
+        uint32_t n = (uint32_t)data[i] << 16;
+        if (i + 1 < len) n |= (uint32_t)data[i + 1] << 8;
+        *dst++ = BASE64_ALPHABET[n >> 18];
+        *dst++ = BASE64_ALPHABET[(n >> 12) & 63];
+        *dst++ = i + 1 < len ? BASE64_ALPHABET[(n >> 6) & 63] : '=';
+        *dst++ = '=';
+    }
+    return out;
+}
+
+// false on characters outside the alphabet or a malformed length
+inline bool base64_decode(const char* src, size_t len, std::vector<uint8_t>& out) {
+    while (len > 0 && src[len - 1] == '=') len--;
+    if (len % 4 == 1) return false;
+    
+    out.resize(len / 4 * 3 + (len % 4 ? len % 4 - 1 : 0));
+    uint8_t* dst = out.data();
+    const uint8_t* table = base64_lookup.value;
+    
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        uint8_t a = table[(uint8_t)src[i]], b = table[(uint8_t)src[i + 1]];
+        uint8_t c = table[(uint8_t)src[i + 2]], d = table[(uint8_t)src[i + 3]];
+        if ((a | b | c | d) & 0x80) return false;
+        uint32_t n = (uint32_t)a << 18 | (uint32_t)b << 12 | (uint32_t)c << 6 | d;
+        *dst++ = (uint8_t)(n >> 16);
+        *dst++ = (uint8_t)(n >> 8);
+        *dst++ = (uint8_t)n;
+    }
+    if (i < len) {
+        uint32_t n = 0;
+        size_t rest = len - i;
+        for (size_t j = 0; j < rest; j++) {
+            uint8_t v = table[(uint8_t)src[i + j]];
+            if (v & 0x80) return false;
+            n |= (uint32_t)v << (18 - 6 * j);
+        }
+        *dst++ = (uint8_t)(n >> 16);
+        if (rest == 3) *dst++ = (uint8_t)(n >> 8);
+    }
+    return true;
+}
+
+} // namespace valkyrie
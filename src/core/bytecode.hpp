@@ -0,0 +1,101 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "hash.hpp"
+#include <quickjs/quickjs.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace valkyrie {
+
+// vfs mime types marking entries that hold precompiled bytecode instead of source
+constexpr const char* SCRIPT_BYTECODE_MIME = "application/x-quickjs-bytecode";
+constexpr const char* MODULE_BYTECODE_MIME = "application/x-quickjs-module-bytecode";
+
+// `valkyrie build --bytecode` also packs each script's source under this path, so
+// an app linked against a QuickJS that rejects the bytecode can still load it
+inline std::string bytecode_source_path(std::string_view path) {
+    return std::string(path) + ".source";
+}
+
+// compiles `code` without running it and serialises the result with
+// JS_WriteObject. `code` must be NUL-terminated at code[len].
+inline bool compile_to_bytecode(JSContext* ctx, const char* code, size_t len, const char* filename,
+                                int eval_flags, std::vector<uint8_t>& out, std::string* error = nullptr) {
+    JSValue func = JS_Eval(ctx, code, len, filename, eval_flags | JS_EVAL_FLAG_COMPILE_ONLY);
+    if (JS_IsException(func)) {
+        JSValue exception = JS_GetException(ctx);
+        if (error) {
+            const char* msg = JS_ToCString(ctx, exception);
+            *error = msg ? msg : "compile error";
+            if (msg) JS_FreeCString(ctx, msg);
+        }
+        JS_FreeValue(ctx, exception);
+        return false;
+    }
+    
+    size_t size = 0;
+    uint8_t* buf = JS_WriteObject(ctx, &size, func, JS_WRITE_OBJ_BYTECODE);
+    JS_FreeValue(ctx, func);
+    if (!buf) {
+        if (error) *error = "failed to serialise bytecode";
+        return false;
+    }
+    out.assign(buf, buf + size);
+    js_free(ctx, buf);
+    return true;
+}
+
+// reads bytecode produced by compile_to_bytecode. throws (returns JS_EXCEPTION)
+// when the blob was written by a different QuickJS version.
+inline JSValue read_bytecode(JSContext* ctx, const uint8_t* data, size_t size) {
+    return JS_ReadObject(ctx, data, size, JS_READ_OBJ_BYTECODE);
+}
+
+inline JSValue eval_bytecode(JSContext* ctx, const uint8_t* data, size_t size) {
+    JSValue func = read_bytecode(ctx, data, size);
+    if (JS_IsException(func)) return func;
+    return JS_EvalFunction(ctx, func);
+}
+
+} // namespace valkyrie
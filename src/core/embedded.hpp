@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "hash.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace valkyrie {
+
+// one file baked into the binary by `valkyrie embed`. `data` has a NUL at
+// data[size] and `hash` is the hash of the original content, computed when the
+// table is generated. with an `encoding` ("zstd") `data` holds the compressed
+// payload and the vfs decodes it on first read.
+struct embedded_file {
+    std::string_view path;
+    const uint8_t* data;
+    size_t size;
+    std::string_view mime_type;
+    uint64_t hash;
+    std::string_view encoding = {};
+};
+
+// slot of a key within a table of `count` files once its bucket's displacement is applied
+constexpr size_t embedded_slot(uint64_t path_hash, uint32_t displacement, size_t count) {
+    uint64_t x = path_hash ^ (displacement * 0x9e3779b97f4a7c15ull);
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return (size_t)(x % count);
+}
+
+// minimal perfect hash (hash and displace) over a generated file list: the
+// path hash picks a bucket, the bucket's displacement picks the one slot the
+// file can be in. read-only, so lookups take no lock and allocate nothing.
+struct embedded_table {
+    const embedded_file* files;
+    size_t count;
+    const uint32_t* displacements;
+    size_t bucket_count;
+    
+    constexpr const embedded_file* find(std::string_view path) const {
+        if (count == 0) return nullptr;
+        uint64_t hash = fnv1a_hash(path);
+        const embedded_file& file = files[embedded_slot(hash, displacements[hash % bucket_count], count)];
+        return file.path == path ? &file : nullptr;
+    }
+};
+
+} // namespace valkyrie
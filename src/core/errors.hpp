@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "allocator.hpp"
+#include <quickjs/quickjs.h>
+#include <functional>
+#include <string>
+
+namespace valkyrie {
+
+// runs on the logic thread once QuickJS reports the heap limit was hit,
+// after a GC pass has given back whatever it could
+static std::function<void(JSContext*)> g_out_of_memory_handler;
+
+// runs the OOM handler if the allocator refused memory since the flag was last
+// cleared. metrics_scope clears it when a macrotask starts and run_microtasks
+// checks it once the task and its jobs are done, so an OOM that JS caught or
+// that only rejected a promise is still seen, and never blamed on a later task.
+inline void check_out_of_memory(JSContext* ctx) {
+    if (!take_allocation_failure()) return;
+    JS_RunGC(JS_GetRuntime(ctx));
+    if (g_out_of_memory_handler) {
+        g_out_of_memory_handler(ctx);
+    }
+}
+
+// the JS call stack at this point, innermost frame first ("    at fn (file:line)").
+// JS_NewError records no backtrace; only the Error constructor fills in "stack".
+inline std::string current_js_stack(JSContext* ctx) {
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue constructor = JS_GetPropertyStr(ctx, global, "Error");
+    JSValue error = JS_CallConstructor(ctx, constructor, 0, nullptr);
+    JS_FreeValue(ctx, constructor);
+    JS_FreeValue(ctx, global);
+    if (JS_IsException(error)) {
+        JS_FreeValue(ctx, JS_GetException(ctx));
+        return "";
+    }
+    JSValue stack = JS_GetPropertyStr(ctx, error, "stack");
+    const char* text = JS_ToCString(ctx, stack);
+    std::string out = text ? text : "";
+    if (text) JS_FreeCString(ctx, text);
+    JS_FreeValue(ctx, stack);
+    JS_FreeValue(ctx, error);
+    return out;
+}
+
+// pops the pending exception and returns its message
+inline std::string take_exception_message(JSContext* ctx) {
+    JSValue exception = JS_GetException(ctx);
+    const char* err = JS_ToCString(ctx, exception);
+    std::string msg = err ? err : "unknown error";
+    if (err) JS_FreeCString(ctx, err);
+    JS_FreeValue(ctx, exception);
+    
+    // asked of the allocator rather than the message, which scripts can forge
+    check_out_of_memory(ctx);
+    return msg;
+}
+
+} // namespace valkyrie
@@ -38,14 +38,15 @@
 
 #pragma once
 
+#include "mpsc_ring.hpp"
 #include "../bindings/system.hpp"
 
 #ifndef VALKYRIE_NO_WEBVIEW
     #include <core/include/webview.h>
 #endif
 #include <string>
-#include <deque>
-#include <mutex>
+#include <vector>
+#include <cstdint>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -57,10 +58,18 @@ namespace valkyrie {
 struct ipc_message {
     std::string data;
     uint64_t timestamp;
+    // webview promise id for valkyrie.invoke(); empty for fire-and-forget sends
+    std::string reply_id;
+    // valkyrie.sendBinary(): `data` is the channel name as a JSON string literal
+    // and the bytes ride here
+    bool is_binary = false;
+    std::vector<uint8_t> binary;
 };
 
-extern std::deque<ipc_message> g_ipc_queue;
-extern std::mutex g_ipc_mutex;
+constexpr size_t IPC_QUEUE_CAPACITY = 4096;
+constexpr size_t IPC_DEFAULT_BATCH_LIMIT = 256;
+
+extern mpsc_ring<ipc_message> g_ipc_queue;
 extern webview::webview* g_webview_ptr;
 
 inline void handle_builtin_command(const std::string& json_str) {
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "allocator.hpp"
+#include <quickjs/quickjs.h>
+#include <uv.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace valkyrie {
+
+// log-linear histogram in the spirit of HdrHistogram: values below 32 get exact
+// buckets, above that every power of two is split into 16 sub-buckets, so any
+// recorded value is within ~6% of its bucket. values are microseconds.
+class latency_histogram {
+public:
+    static constexpr int SUB_BITS = 4;
+    static constexpr int SUB_COUNT = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS) * SUB_COUNT + 2 * SUB_COUNT;
+    
+    void record(uint64_t value) {
+        counts_[bucket_of(value)]++;
+        count_++;
+        sum_ += value;
+        if (value < min_) min_ = value;
+        if (value > max_) max_ = value;
+    }
+    
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? (double)sum_ / count_ : 0; }
+    
+    // upper edge of the bucket holding the p-th percentile, capped at max()
+    uint64_t percentile(double p) const {
+        if (count_ == 0) return 0;
+        uint64_t target = (uint64_t)(count_ * p / 100.0 + 0.5);
+        if (target == 0) target = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += counts_[i];
+            if (seen >= target) {
+                uint64_t upper = bucket_start(i + 1) - 1;
+                return upper < max_ ? upper : max_;
+            }
+        }
+        return max_;
+    }
+    
+    void reset() { *this = latency_histogram(); }
+    
+private:
+    static int bucket_of(uint64_t value) {
+        if (value < 2 * SUB_COUNT) return (int)value;
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - SUB_BITS;
+        return shift * SUB_COUNT + (int)(value >> shift);
+    }
+    
+    static uint64_t bucket_start(int index) {
+        if (index < 2 * SUB_COUNT) return (uint64_t)index;
+        int shift = index / SUB_COUNT - 1;
+        uint64_t mantissa = (uint64_t)(index % SUB_COUNT + SUB_COUNT);
+        return mantissa << shift;
+    }
+    
+    uint64_t counts_[BUCKETS] = {};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+enum class metric_category {
+    ipc,    // handleCommand dispatch in async_cb
+    timer,  // setTimeout/setInterval/setImmediate callbacks
+    socket, // NativeSocket connect/read callbacks
+    http,   // fetch completions
+    task,   // work posted through app::post/eval_async
+    microtask, // promise jobs left over for the check handle to drain
+    count
+};
+
+static const char* const METRIC_CATEGORY_NAMES[] = {"ipc", "timer", "socket", "http", "task", "microtask"};
+
+constexpr uint64_t LOOP_LAG_INTERVAL_MS = 50;
+
+struct loop_metrics {
+    latency_histogram callbacks[(int)metric_category::count];
+    latency_histogram ipc_wait;  // native_send -> dispatch on the logic thread
+    latency_histogram loop_lag;  // lateness of a fixed-interval probe timer
+    uint64_t start_time = 0;
+    uint64_t lag_expected = 0;
+};
+
+// logic-thread only, like the rest of the loop state
+static loop_metrics g_metrics;
+static uv_loop_t* g_metrics_loop = nullptr;
+static uv_timer_t g_lag_timer;
+static bool g_lag_timer_ready = false;
+static uv_timer_t g_metrics_dump_timer;
+static bool g_metrics_dump_ready = false;
+static std::string g_metrics_dump_path;
+
+// the outermost metrics_scope is the macrotask the logic thread is running;
+// the long-task watchdog measures against it
+struct current_task {
+    uint64_t start = 0; // 0 while the loop is between callbacks
+    uint64_t sequence = 0;
+    metric_category category = metric_category::ipc;
+    int depth = 0;
+};
+
+static current_task g_current_task;
+
+// times the enclosing callback into its category
+class metrics_scope {
+public:
+    explicit metrics_scope(metric_category category) : category_(category), start_(uv_hrtime()) {
+        if (g_current_task.depth++ == 0) {
+            // a new macrotask; allocation failures from earlier ones were checked already
+            allocation_failed_flag() = false;
+            g_current_task.start = start_;
+            g_current_task.sequence++;
+            g_current_task.category = category;
+        }
+    }
+    ~metrics_scope() {
+        g_metrics.callbacks[(int)category_].record((uv_hrtime() - start_) / 1000);
+        if (--g_current_task.depth == 0) {
+            g_current_task.start = 0;
+        }
+    }
+    
+    metrics_scope(const metrics_scope&) = delete;
+    metrics_scope& operator=(const metrics_scope&) = delete;
+    
+private:
+    metric_category category_;
+    uint64_t start_;
+};
+
+inline void record_ipc_wait(uint64_t enqueued_at) {
+    if (enqueued_at) g_metrics.ipc_wait.record((uv_hrtime() - enqueued_at) / 1000);
+}
+
+inline void append_histogram_json(std::string& out, const char* name, const latency_histogram& h) {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "\"%s\":{\"count\":%llu,\"min\":%.3f,\"mean\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"max\":%.3f}",
+             name, (unsigned long long)h.count(), h.min() / 1000.0, h.mean() / 1000.0,
+             h.percentile(50) / 1000.0, h.percentile(90) / 1000.0, h.percentile(99) / 1000.0, h.max() / 1000.0);
+    out += buf;
+}
+
+// all durations in milliseconds
+inline std::string metrics_json() {
+    uint64_t now = uv_hrtime();
+    double uptime_ms = (now - g_metrics.start_time) / 1e6;
+    double idle_ms = 0;
+#if defined(UV_VERSION_HEX) && UV_VERSION_HEX >= 0x012700
+    if (g_metrics_loop) idle_ms = uv_metrics_idle_time(g_metrics_loop) / 1e6;
+#endif
+    
+    char buf[160];
+    snprintf(buf, sizeof(buf), "{\"timestamp\":%llu,\"uptimeMs\":%.3f,\"idleMs\":%.3f,\"utilization\":%.4f,",
+             (unsigned long long)uv_now(g_metrics_loop ? g_metrics_loop : uv_default_loop()),
+             uptime_ms, idle_ms, uptime_ms > 0 ? 1.0 - idle_ms / uptime_ms : 0.0);
+    
+    std::string out = buf;
+    append_histogram_json(out, "loopLag", g_metrics.loop_lag);
+    out += ',';
+    append_histogram_json(out, "ipcWait", g_metrics.ipc_wait);
+    out += ",\"callbacks\":{";
+    for (int i = 0; i < (int)metric_category::count; i++) {
+        if (i) out += ',';
+        append_histogram_json(out, METRIC_CATEGORY_NAMES[i], g_metrics.callbacks[i]);
+    }
+    out += "}}";
+    return out;
+}
+
+static void lag_timer_cb(uv_timer_t* handle) {
+    uint64_t now = uv_hrtime();
+    if (g_metrics.lag_expected && now > g_metrics.lag_expected) {
+        g_metrics.loop_lag.record((now - g_metrics.lag_expected) / 1000);
+    } else if (g_metrics.lag_expected) {
+        g_metrics.loop_lag.record(0);
+    }
+    g_metrics.lag_expected = now + LOOP_LAG_INTERVAL_MS * 1000000;
+}
+
+// the probe wakes the loop every LOOP_LAG_INTERVAL_MS, so an idle backend only
+// pays for it once metrics are asked for (env var or the first valkyrie.metrics())
+inline void start_lag_probe() {
+    if (g_lag_timer_ready || !g_metrics_loop) return;
+    uv_timer_init(g_metrics_loop, &g_lag_timer);
+    uv_timer_start(&g_lag_timer, lag_timer_cb, LOOP_LAG_INTERVAL_MS, LOOP_LAG_INTERVAL_MS);
+    uv_unref((uv_handle_t*)&g_lag_timer);
+    g_metrics.lag_expected = uv_hrtime() + LOOP_LAG_INTERVAL_MS * 1000000;
+    g_lag_timer_ready = true;
+}
+
+static JSValue js_metrics(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    start_lag_probe();
+    std::string json = metrics_json();
+    return JS_ParseJSON(ctx, json.c_str(), json.size(), "<metrics>");
+}
+
+static JSValue js_metrics_reset(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    for (auto& h : g_metrics.callbacks) h.reset();
+    g_metrics.ipc_wait.reset();
+    g_metrics.loop_lag.reset();
+    return JS_UNDEFINED;
+}
+
+static void metrics_dump_cb(uv_timer_t* handle) {
+    FILE* fp = fopen(g_metrics_dump_path.c_str(), "a");
+    if (!fp) return;
+    std::string json = metrics_json();
+    fprintf(fp, "%s\n", json.c_str());
+    fclose(fp);
+}
+
+// must run before uv_run so idle time is accounted from the start.
+// VALKYRIE_METRICS_FILE appends one JSON line every VALKYRIE_METRICS_INTERVAL_MS;
+// VALKYRIE_METRICS=1 starts the loop lag probe without writing a file.
+inline void init_metrics(uv_loop_t* loop) {
+    g_metrics = loop_metrics();
+    g_metrics.start_time = uv_hrtime();
+    g_metrics_loop = loop;
+#if defined(UV_VERSION_HEX) && UV_VERSION_HEX >= 0x012700
+    uv_loop_configure(loop, UV_METRICS_IDLE_TIME);
+#endif
+    
+    const char* enabled = getenv("VALKYRIE_METRICS");
+    if (enabled && *enabled && strcmp(enabled, "0") != 0) {
+        start_lag_probe();
+    }
+    
+    const char* path = getenv("VALKYRIE_METRICS_FILE");
+    if (path && *path) {
+        start_lag_probe();
+        g_metrics_dump_path = path;
+        uint64_t interval = 10000;
+        if (const char* ms = getenv("VALKYRIE_METRICS_INTERVAL_MS")) {
+            uint64_t parsed = strtoull(ms, nullptr, 10);
+            if (parsed > 0) interval = parsed;
+        }
+        uv_timer_init(loop, &g_metrics_dump_timer);
+        uv_timer_start(&g_metrics_dump_timer, metrics_dump_cb, interval, interval);
+        uv_unref((uv_handle_t*)&g_metrics_dump_timer);
+        g_metrics_dump_ready = true;
+    }
+}
+
+inline void close_metrics() {
+    if (!g_metrics_loop) return;
+    if (g_lag_timer_ready) {
+        uv_close((uv_handle_t*)&g_lag_timer, nullptr);
+        g_lag_timer_ready = false;
+    }
+    if (g_metrics_dump_ready) {
+        metrics_dump_cb(&g_metrics_dump_timer);
+        uv_close((uv_handle_t*)&g_metrics_dump_timer, nullptr);
+        g_metrics_dump_ready = false;
+    }
+    g_metrics_loop = nullptr;
+}
+
+} // namespace valkyrie
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "errors.hpp"
+#include "metrics.hpp"
+#include <quickjs/quickjs.h>
+#include <uv.h>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+
+namespace valkyrie {
+
+struct microtask_stats {
+    uint64_t ticks = 0;            // pump invocations that ran at least one job
+    uint64_t jobs_total = 0;
+    uint64_t budget_exhausted = 0; // ticks that stopped with jobs still queued
+    uint32_t last_tick = 0;        // jobs run by the most recent tick
+    uint32_t max_tick = 0;
+};
+
+static microtask_stats g_microtask_stats;
+static std::atomic<size_t> g_microtask_budget{1000};
+static uv_check_t g_microtask_check;
+static uv_idle_t g_microtask_idle;
+static bool g_microtask_pump_ready = false;
+
+static void microtask_idle_cb(uv_idle_t* handle) {
+    // only exists to keep uv_run from blocking in poll while jobs are queued;
+    // the check handle does the actual draining
+}
+
+// drains the QuickJS job queue (promise reactions, queueMicrotask) after a
+// macrotask. bounded so a self-rescheduling promise chain cannot wedge the
+// loop; leftovers keep the idle handle running and continue next iteration.
+inline void run_microtasks(JSContext* ctx) {
+    if (!ctx) return;
+    JSRuntime* rt = JS_GetRuntime(ctx);
+    
+    size_t budget = g_microtask_budget.load(std::memory_order_relaxed);
+    uint32_t ran = 0;
+    while (ran < budget && JS_IsJobPending(rt)) {
+        JSContext* job_ctx = nullptr;
+        int status = JS_ExecutePendingJob(rt, &job_ctx);
+        if (status == 0) break;
+        ran++;
+        if (status < 0 && job_ctx) {
+            std::cerr << "Unhandled job error: " << take_exception_message(job_ctx) << std::endl;
+        }
+    }
+    
+    bool pending = JS_IsJobPending(rt);
+    if (ran > 0) {
+        g_microtask_stats.ticks++;
+        g_microtask_stats.jobs_total += ran;
+        g_microtask_stats.last_tick = ran;
+        if (ran > g_microtask_stats.max_tick) g_microtask_stats.max_tick = ran;
+        if (pending) g_microtask_stats.budget_exhausted++;
+    }
+    
+    if (g_microtask_pump_ready) {
+        if (pending) {
+            uv_idle_start(&g_microtask_idle, microtask_idle_cb);
+        } else {
+            uv_idle_stop(&g_microtask_idle);
+        }
+    }
+    
+    // every macrotask ends here
+    check_out_of_memory(ctx);
+}
+
+static void microtask_check_cb(uv_check_t* handle) {
+    JSContext* ctx = (JSContext*)handle->data;
+    if (!ctx || !JS_IsJobPending(JS_GetRuntime(ctx))) return;
+    // a macrotask of its own, so the watchdog can stop a runaway promise chain
+    metrics_scope scope(metric_category::microtask);
+    run_microtasks(ctx);
+}
+
+// the check handle catches jobs queued by callbacks that do not pump themselves
+inline void init_microtask_pump(uv_loop_t* loop, JSContext* ctx) {
+    uv_check_init(loop, &g_microtask_check);
+    g_microtask_check.data = ctx;
+    uv_check_start(&g_microtask_check, microtask_check_cb);
+    uv_idle_init(loop, &g_microtask_idle);
+    g_microtask_pump_ready = true;
+}
+
+inline void close_microtask_pump() {
+    if (!g_microtask_pump_ready) return;
+    g_microtask_pump_ready = false;
+    uv_close((uv_handle_t*)&g_microtask_check, nullptr);
+    uv_close((uv_handle_t*)&g_microtask_idle, nullptr);
+}
+
+} // namespace valkyrie
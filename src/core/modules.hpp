@@ -0,0 +1,333 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "vfs.hpp"
+#include "bytecode.hpp"
+#include "../bindings/net.hpp"
+#include <quickjs/quickjs.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+namespace valkyrie {
+
+struct compiled_module {
+    uint64_t source_hash = 0;
+    std::vector<uint8_t> bytecode;
+};
+
+// per-require compile state, owned by a hidden object in require's func_data
+// so it lives and dies with the context. bytecode is kept for modules required
+// again after `delete require.cache[id]`: later reloads skip the parser and
+// only re-run the module body, and modules loaded once are never serialised.
+// entries are tied to the vfs content hash, so re-registered source recompiles.
+struct module_compile_cache {
+    std::unordered_map<std::string, compiled_module> compiled;
+    std::unordered_map<std::string, uint64_t> loaded; // id -> hash of the source last compiled
+};
+
+static JSClassID js_module_cache_class_id;
+
+static void js_module_cache_finalizer(JSRuntime* rt, JSValue val) {
+    delete (module_compile_cache*)JS_GetOpaque(val, js_module_cache_class_id);
+}
+
+static JSClassDef js_module_cache_class = {
+    "ModuleCompileCache",
+    js_module_cache_finalizer,
+};
+
+// JS_ReadObject rejects bytecode written by another QuickJS version; compile
+// the source packed beside it instead (`build --bytecode-with-source`).
+// `eval_flags` picks script or module.
+static JSValue read_packed_bytecode(JSContext* ctx, const std::string& id, const vfs::file_entry& file, int eval_flags) {
+    JSValue func = read_bytecode(ctx, file.data.data(), file.data.size());
+    if (!JS_IsException(func)) return func;
+    
+    auto source = vfs::instance().read_file(bytecode_source_path(id));
+    if (!source) return func;
+    JS_FreeValue(ctx, JS_GetException(ctx));
+    std::string_view code = source->text();
+    return JS_Eval(ctx, code.data(), code.size(), id.c_str(), eval_flags | JS_EVAL_FLAG_COMPILE_ONLY);
+}
+
+static JSValue load_module_function(JSContext* ctx, module_compile_cache& cache, const std::string& id,
+                                    const vfs::file_entry& file) {
+    if (file.mime_type == SCRIPT_BYTECODE_MIME) {
+        return read_packed_bytecode(ctx, id, file, JS_EVAL_TYPE_GLOBAL);
+    }
+    if (file.mime_type == MODULE_BYTECODE_MIME) {
+        return JS_ThrowTypeError(ctx, "cannot require ES module '%s', use import", id.c_str());
+    }
+    
+    auto cached = cache.compiled.find(id);
+    if (cached != cache.compiled.end()) {
+        if (cached->second.source_hash == file.hash) {
+            JSValue func = read_bytecode(ctx, cached->second.bytecode.data(), cached->second.bytecode.size());
+            if (!JS_IsException(func)) return func;
+            JS_FreeValue(ctx, JS_GetException(ctx));
+        }
+        cache.compiled.erase(cached);
+    }
+    
+    // `code` is NUL-terminated at code[size()], as vfs entries are
+    std::string_view code = file.text();
+    auto loaded = cache.loaded.try_emplace(id, file.hash);
+    if (loaded.second || loaded.first->second != file.hash) {
+        loaded.first->second = file.hash;
+        return JS_Eval(ctx, code.data(), code.size(), id.c_str(), JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+    }
+    
+    std::vector<uint8_t> bytecode;
+    if (!compile_to_bytecode(ctx, code.data(), code.size(), id.c_str(), JS_EVAL_TYPE_GLOBAL, bytecode)) {
+        // re-parse so the caller gets the original SyntaxError rather than a copy
+        return JS_Eval(ctx, code.data(), code.size(), id.c_str(), JS_EVAL_TYPE_GLOBAL | JS_EVAL_FLAG_COMPILE_ONLY);
+    }
+    compiled_module& stored = cache.compiled[id];
+    stored.source_hash = file.hash;
+    stored.bytecode = std::move(bytecode);
+    return read_bytecode(ctx, stored.bytecode.data(), stored.bytecode.size());
+}
+
+// joins a relative specifier onto the importing module's directory and
+// collapses "." / ".." segments. vfs keys have no leading slash.
+static std::string normalize_module_path(const std::string& base, const std::string& name) {
+    std::string joined = name;
+    size_t slash = base.rfind('/');
+    if (slash != std::string::npos) {
+        joined = base.substr(0, slash) + "/" + name;
+    }
+    
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start <= joined.size()) {
+        size_t end = joined.find('/', start);
+        if (end == std::string::npos) end = joined.size();
+        std::string seg = joined.substr(start, end - start);
+        if (seg == "..") {
+            if (!parts.empty()) parts.pop_back();
+        } else if (!seg.empty() && seg != ".") {
+            parts.push_back(seg);
+        }
+        start = end + 1;
+    }
+    
+    std::string result;
+    for (const auto& part : parts) {
+        if (!result.empty()) result += '/';
+        result += part;
+    }
+    return result;
+}
+
+// picks the vfs key a specifier refers to, trying the usual extensions so
+// "./util" and "./util.js" end up as the same module record
+static std::string resolve_module_path(const std::string& name) {
+    std::string path = (!name.empty() && name[0] == '/') ? name.substr(1) : name;
+    const char* suffixes[] = {"", ".js", ".mjs", "/index.js"};
+    for (const char* suffix : suffixes) {
+        if (vfs::instance().exists(path + suffix)) {
+            return path + suffix;
+        }
+    }
+    return path;
+}
+
+static void delete_cache_entry(JSContext* ctx, JSValueConst cache, const std::string& id) {
+    JSAtom atom = JS_NewAtom(ctx, id.c_str());
+    JS_DeleteProperty(ctx, cache, atom, 0);
+    JS_FreeAtom(ctx, atom);
+}
+
+// stores the exports of require.cache[id] in `exports`; false when `id` is not cached
+static bool cached_exports(JSContext* ctx, JSValueConst cache, const std::string& id, JSValue* exports) {
+    JSValue cached = JS_GetPropertyStr(ctx, cache, id.c_str());
+    bool hit = JS_IsObject(cached);
+    if (hit) *exports = JS_GetPropertyStr(ctx, cached, "exports");
+    JS_FreeValue(ctx, cached);
+    return hit;
+}
+
+// require(name) with a Node-style require.cache keyed by resolved path. the
+// module is cached before its body runs, so cyclic requires see the partially
+// populated exports instead of recursing.
+static JSValue js_require(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv, int magic, JSValue* func_data) {
+    JSValueConst cache = func_data[0];
+    auto* compile_cache = (module_compile_cache*)JS_GetOpaque(func_data[1], js_module_cache_class_id);
+    
+    const char* module_name = JS_ToCString(ctx, argv[0]);
+    if (!module_name) return JS_EXCEPTION;
+    
+    std::string path = module_name;
+    JS_FreeCString(ctx, module_name);
+    
+    if (path == "http" || path == "https") {
+        JSValue exports;
+        if (cached_exports(ctx, cache, path, &exports)) return exports;
+        
+        JSValue module_obj = JS_NewObject(ctx);
+        exports = JS_NewObject(ctx);
+        JS_SetPropertyStr(ctx, exports, "fetch", JS_NewCFunction(ctx, js_http_fetch, "fetch", 1));
+        JS_SetPropertyStr(ctx, module_obj, "exports", JS_DupValue(ctx, exports));
+        JS_SetPropertyStr(ctx, cache, path.c_str(), module_obj);
+        return exports;
+    }
+    
+    // relative specifiers resolve against the calling script, as import does;
+    // level 0 is require itself, level 1 the JS function that called it
+    if (path[0] == '.') {
+        std::string base;
+        JSAtom caller = JS_GetScriptOrModuleName(ctx, 1);
+        if (caller != JS_ATOM_NULL) {
+            const char* name = JS_AtomToCString(ctx, caller);
+            if (name) {
+                base = name[0] == '/' ? name + 1 : name;
+                JS_FreeCString(ctx, name);
+            }
+            JS_FreeAtom(ctx, caller);
+        }
+        path = normalize_module_path(base, path);
+    }
+    std::string id = resolve_module_path(path);
+    
+    JSValue exports;
+    if (cached_exports(ctx, cache, id, &exports)) return exports;
+    
+    auto file = vfs::instance().read_file(id);
+    if (!file) {
+        return JS_ThrowReferenceError(ctx, "Module not found: %s", path.c_str());
+    }
+    
+    JSValue module_obj = JS_NewObject(ctx);
+    JS_SetPropertyStr(ctx, module_obj, "exports", JS_NewObject(ctx));
+    JS_SetPropertyStr(ctx, module_obj, "id", JS_NewString(ctx, id.c_str()));
+    JS_SetPropertyStr(ctx, module_obj, "loaded", JS_FALSE);
+    JS_SetPropertyStr(ctx, cache, id.c_str(), JS_DupValue(ctx, module_obj));
+    
+    JSValue func = load_module_function(ctx, *compile_cache, id, *file);
+    if (JS_IsException(func)) {
+        delete_cache_entry(ctx, cache, id);
+        JS_FreeValue(ctx, module_obj);
+        return func;
+    }
+    
+    JSValue global = JS_GetGlobalObject(ctx);
+    JSValue old_module = JS_GetPropertyStr(ctx, global, "module");
+    JSValue old_exports = JS_GetPropertyStr(ctx, global, "exports");
+    
+    JS_SetPropertyStr(ctx, global, "module", JS_DupValue(ctx, module_obj));
+    JS_SetPropertyStr(ctx, global, "exports", JS_GetPropertyStr(ctx, module_obj, "exports"));
+    
+    JSValue result = JS_EvalFunction(ctx, func);
+    
+    JS_SetPropertyStr(ctx, global, "module", old_module);
+    JS_SetPropertyStr(ctx, global, "exports", old_exports);
+    JS_FreeValue(ctx, global);
+    
+    if (JS_IsException(result)) {
+        delete_cache_entry(ctx, cache, id);
+        JS_FreeValue(ctx, module_obj);
+        return result;
+    }
+    
+    JS_FreeValue(ctx, result);
+    JS_SetPropertyStr(ctx, module_obj, "loaded", JS_TRUE);
+    
+    JSValue ret = JS_GetPropertyStr(ctx, module_obj, "exports");
+    JS_FreeValue(ctx, module_obj);
+    return ret;
+}
+
+static char* js_module_normalize(JSContext* ctx, const char* base_name, const char* module_name, void* opaque) {
+    std::string name = module_name;
+    if (name[0] == '.') {
+        name = normalize_module_path(base_name, name);
+    }
+    return js_strdup(ctx, resolve_module_path(name).c_str());
+}
+
+static JSModuleDef* js_module_loader(JSContext* ctx, const char* module_name, void* opaque) {
+    auto file = vfs::instance().read_file(module_name);
+    if (!file) {
+        JS_ThrowReferenceError(ctx, "could not load module '%s'", module_name);
+        return nullptr;
+    }
+    
+    JSValue func;
+    if (file->mime_type == MODULE_BYTECODE_MIME) {
+        func = read_packed_bytecode(ctx, module_name, *file, JS_EVAL_TYPE_MODULE);
+    } else {
+        func = JS_Eval(ctx, (const char*)file->data.data(), file->data.size(), module_name, JS_EVAL_TYPE_MODULE | JS_EVAL_FLAG_COMPILE_ONLY);
+    }
+    if (JS_IsException(func)) {
+        return nullptr;
+    }
+    
+    JSModuleDef* m = (JSModuleDef*)JS_VALUE_GET_PTR(func);
+    JSValue meta = JS_GetImportMeta(ctx, m);
+    JS_SetPropertyStr(ctx, meta, "url", JS_NewString(ctx, module_name));
+    JS_SetPropertyStr(ctx, meta, "main", JS_FALSE);
+    JS_FreeValue(ctx, meta);
+    
+    JS_FreeValue(ctx, func);
+    return m;
+}
+
+inline void install_module_loader(JSRuntime* rt) {
+    JS_SetModuleLoaderFunc(rt, js_module_normalize, js_module_loader, nullptr);
+}
+
+inline bool is_module_source(std::string_view path, std::string_view code) {
+    if (path.size() > 4 && path.compare(path.size() - 4, 4, ".mjs") == 0) return true;
+    return JS_DetectModule(code.data(), code.size()) != 0;
+}
+
+// `rt` must have js_module_cache_class registered (see app::logic_thread_main)
+inline JSValue js_new_require(JSContext* ctx) {
+    JSValue data[2] = {JS_NewObject(ctx), JS_NewObjectClass(ctx, js_module_cache_class_id)};
+    JS_SetOpaque(data[1], new module_compile_cache());
+    JSValue require = JS_NewCFunctionData(ctx, js_require, 1, 0, 2, data);
+    JS_SetPropertyStr(ctx, require, "cache", data[0]);
+    JS_FreeValue(ctx, data[1]);
+    return require;
+}
+
+} // namespace valkyrie
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace valkyrie {
+
+// bounded multi-producer/single-consumer ring (Vyukov-style sequenced cells).
+// producers never take a lock; the single consumer is the logic thread.
+template <typename T>
+class mpsc_ring {
+public:
+    explicit mpsc_ring(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        cells_ = std::make_unique<cell[]>(cap);
+        for (size_t i = 0; i < cap; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpsc_ring(const mpsc_ring&) = delete;
+    mpsc_ring& operator=(const mpsc_ring&) = delete;
+
+    // leaves `value` untouched when the ring is full
+    bool try_push(T&& value) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        cell* c;
+        for (;;) {
+            c = &cells_[pos & mask_];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        c->value = std::move(value);
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side only
+    bool try_pop(T& out) {
+        cell* c = &cells_[dequeue_pos_ & mask_];
+        size_t seq = c->sequence.load(std::memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(dequeue_pos_ + 1) < 0) {
+            return false;
+        }
+        out = std::move(c->value);
+        c->value = T();
+        c->sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+        dequeue_pos_++;
+        return true;
+    }
+
+    bool empty() const {
+        const cell& c = cells_[dequeue_pos_ & mask_];
+        return (intptr_t)c.sequence.load(std::memory_order_acquire) - (intptr_t)(dequeue_pos_ + 1) < 0;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) size_t dequeue_pos_ = 0;
+};
+
+} // namespace valkyrie
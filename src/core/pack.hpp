@@ -0,0 +1,284 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "embedded.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #ifdef __APPLE__
+        #include <mach-o/dyld.h>
+    #endif
+#endif
+
+namespace valkyrie {
+
+// asset pack written by `valkyrie build` and appended to the stripped binary
+// (or left next to it as <binary>.pack):
+//
+//   [blobs][index][trailer]
+//
+// blobs start on PACK_ALIGNMENT boundaries and are each followed by a NUL.
+// the index is a pack_index_header, its displacement array, the pack_entry
+// records in slot order, then the path/mime/encoding strings. offsets are
+// relative to the start of the pack (index strings: to the start of the
+// index), fields are little-endian, and the trailer is the last 32 bytes of the file.
+constexpr char PACK_MAGIC[8] = {'V', 'L', 'K', 'P', 'A', 'C', 'K', '1'};
+constexpr size_t PACK_ALIGNMENT = 16;
+
+struct pack_trailer {
+    char magic[8];
+    uint64_t index_offset;
+    uint64_t index_size;
+    uint64_t pack_size;
+};
+
+struct pack_index_header {
+    uint32_t count;
+    uint32_t bucket_count;
+};
+
+struct pack_entry {
+    uint64_t data_offset;
+    uint64_t size;
+    uint64_t hash;
+    uint32_t path_offset;
+    uint32_t path_size;
+    uint32_t mime_offset;
+    uint32_t mime_size;
+    uint32_t encoding_offset;
+    uint32_t encoding_size;
+};
+
+static_assert(sizeof(pack_trailer) == 32 && sizeof(pack_index_header) == 8 && sizeof(pack_entry) == 48);
+
+// displacements are followed by padding so the entries are 8-byte aligned
+constexpr size_t pack_entries_offset(uint32_t bucket_count) {
+    return (sizeof(pack_index_header) + bucket_count * sizeof(uint32_t) + 7) & ~size_t(7);
+}
+
+inline std::string executable_path() {
+#ifdef _WIN32
+    char buf[MAX_PATH];
+    DWORD len = GetModuleFileNameA(nullptr, buf, sizeof(buf));
+    return len > 0 && len < sizeof(buf) ? std::string(buf, len) : "";
+#elif defined(__APPLE__)
+    char buf[4096];
+    uint32_t size = sizeof(buf);
+    return _NSGetExecutablePath(buf, &size) == 0 ? std::string(buf) : "";
+#else
+    char buf[4096];
+    ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf));
+    return len > 0 && (size_t)len < sizeof(buf) ? std::string(buf, len) : "";
+#endif
+}
+
+// read-only mapping of a pack. the index is turned into an embedded_table over
+// the mapping, so mounting copies no asset bytes and the kernel pages blobs in
+// on first touch.
+class asset_pack {
+public:
+    asset_pack() = default;
+    asset_pack(const asset_pack&) = delete;
+    asset_pack& operator=(const asset_pack&) = delete;
+    
+    ~asset_pack() {
+        unmap();
+    }
+    
+    // false when `path` has no valid pack at its end
+    bool open(const std::string& path) {
+        if (!map_file(path)) return false;
+        if (parse()) return true;
+        unmap();
+        return false;
+    }
+    
+    const embedded_table& table() const { return table_; }
+
+private:
+    bool parse() {
+        // the view starts `skew_` bytes before the pack, at an allocation boundary
+        const uint8_t* pack = map_ + skew_;
+        size_t pack_size = map_size_ - skew_;
+        
+        pack_trailer trailer;
+        memcpy(&trailer, pack + pack_size - sizeof(trailer), sizeof(trailer));
+        if (trailer.pack_size != pack_size || trailer.index_size < sizeof(pack_index_header) ||
+            trailer.index_offset > pack_size - sizeof(trailer) ||
+            trailer.index_size > pack_size - sizeof(trailer) - trailer.index_offset) {
+            return false;
+        }
+        
+        const uint8_t* index = pack + trailer.index_offset;
+        pack_index_header header;
+        memcpy(&header, index, sizeof(header));
+        size_t entries = pack_entries_offset(header.bucket_count);
+        if ((header.count > 0 && header.bucket_count == 0) ||
+            entries + (uint64_t)header.count * sizeof(pack_entry) > trailer.index_size) {
+            return false;
+        }
+        
+        auto in_index = [&trailer](uint32_t offset, uint32_t size) {
+            return (uint64_t)offset + size <= trailer.index_size;
+        };
+        auto text = [index](uint32_t offset, uint32_t size) {
+            return std::string_view((const char*)index + offset, size);
+        };
+        
+        displacements_.resize(header.bucket_count);
+        memcpy(displacements_.data(), index + sizeof(header), header.bucket_count * sizeof(uint32_t));
+        
+        files_.reserve(header.count);
+        for (uint32_t i = 0; i < header.count; i++) {
+            pack_entry entry;
+            memcpy(&entry, index + entries + i * sizeof(pack_entry), sizeof(entry));
+            // the blob and its NUL must sit before the index
+            if (entry.data_offset > trailer.index_offset || entry.size >= trailer.index_offset - entry.data_offset ||
+                !in_index(entry.path_offset, entry.path_size) || !in_index(entry.mime_offset, entry.mime_size) ||
+                !in_index(entry.encoding_offset, entry.encoding_size)) {
+                return false;
+            }
+            files_.push_back(embedded_file{text(entry.path_offset, entry.path_size), pack + entry.data_offset,
+                                           (size_t)entry.size, text(entry.mime_offset, entry.mime_size), entry.hash,
+                                           text(entry.encoding_offset, entry.encoding_size)});
+        }
+        
+        table_ = embedded_table{files_.data(), files_.size(), displacements_.data(), displacements_.size()};
+        return true;
+    }
+    
+#ifdef _WIN32
+    bool map_file(const std::string& path) {
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        
+        LARGE_INTEGER size;
+        pack_trailer trailer;
+        DWORD read = 0;
+        LARGE_INTEGER tail;
+        tail.QuadPart = -(LONGLONG)sizeof(trailer);
+        bool ok = GetFileSizeEx(file, &size) && (uint64_t)size.QuadPart > sizeof(trailer) &&
+                  SetFilePointerEx(file, tail, nullptr, FILE_END) &&
+                  ReadFile(file, &trailer, sizeof(trailer), &read, nullptr) && read == sizeof(trailer) &&
+                  memcmp(trailer.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0 &&
+                  trailer.pack_size >= sizeof(trailer) && trailer.pack_size <= (uint64_t)size.QuadPart;
+        if (!ok) {
+            CloseHandle(file);
+            return false;
+        }
+        
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        uint64_t file_size = size.QuadPart;
+        uint64_t start = file_size - trailer.pack_size;
+        uint64_t aligned = start - start % info.dwAllocationGranularity;
+        
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping) return false;
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, (DWORD)(aligned >> 32), (DWORD)aligned, (SIZE_T)(file_size - aligned));
+        CloseHandle(mapping);
+        if (!view) return false;
+        
+        map_ = (const uint8_t*)view;
+        map_size_ = file_size - aligned;
+        skew_ = start - aligned;
+        return true;
+    }
+    
+    void unmap() {
+        if (map_) UnmapViewOfFile(map_);
+        map_ = nullptr;
+    }
+#else
+    bool map_file(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        
+        struct stat st;
+        pack_trailer trailer;
+        bool ok = fstat(fd, &st) == 0 && (uint64_t)st.st_size > sizeof(trailer) &&
+                  pread(fd, &trailer, sizeof(trailer), st.st_size - sizeof(trailer)) == (ssize_t)sizeof(trailer) &&
+                  memcmp(trailer.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0 &&
+                  trailer.pack_size >= sizeof(trailer) && trailer.pack_size <= (uint64_t)st.st_size;
+        if (!ok) {
+            ::close(fd);
+            return false;
+        }
+        
+        uint64_t file_size = st.st_size;
+        uint64_t start = file_size - trailer.pack_size;
+        uint64_t aligned = start - start % (uint64_t)sysconf(_SC_PAGESIZE);
+        void* view = mmap(nullptr, file_size - aligned, PROT_READ, MAP_PRIVATE, fd, (off_t)aligned);
+        ::close(fd);
+        if (view == MAP_FAILED) return false;
+        
+        map_ = (const uint8_t*)view;
+        map_size_ = file_size - aligned;
+        skew_ = start - aligned;
+        return true;
+    }
+    
+    void unmap() {
+        if (map_) munmap((void*)map_, map_size_);
+        map_ = nullptr;
+    }
+#endif
+    
+    const uint8_t* map_ = nullptr;
+    size_t map_size_ = 0;
+    size_t skew_ = 0;
+    std::vector<embedded_file> files_;
+    std::vector<uint32_t> displacements_;
+    embedded_table table_{};
+};
+
+} // namespace valkyrie
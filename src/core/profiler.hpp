@@ -0,0 +1,322 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "errors.hpp"
+#include <quickjs/quickjs.h>
+#include <uv.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace valkyrie {
+
+struct profile_frame {
+    std::string function;
+    std::string url;
+    int line = 0;   // 1-based, 0 when unknown
+    int column = 0;
+};
+
+// parses one "    at fn (file:line:col)" line of a QuickJS Error.stack
+inline profile_frame parse_stack_line(const std::string& raw) {
+    profile_frame frame;
+    std::string line = raw;
+    size_t at = line.find("at ");
+    if (at != std::string::npos) line = line.substr(at + 3);
+    
+    std::string location = line;
+    size_t paren = line.find(" (");
+    if (paren != std::string::npos && line.back() == ')') {
+        frame.function = line.substr(0, paren);
+        location = line.substr(paren + 2, line.size() - paren - 3);
+    } else {
+        frame.function = "(anonymous)";
+    }
+    
+    // peel up to two trailing :number groups off the location
+    int numbers[2] = {0, 0};
+    int found = 0;
+    while (found < 2) {
+        size_t colon = location.rfind(':');
+        if (colon == std::string::npos || colon + 1 == location.size()) break;
+        std::string tail = location.substr(colon + 1);
+        if (tail.find_first_not_of("0123456789") != std::string::npos) break;
+        numbers[found++] = atoi(tail.c_str());
+        location.resize(colon);
+    }
+    if (found == 2) {
+        frame.line = numbers[1];
+        frame.column = numbers[0];
+    } else if (found == 1) {
+        frame.line = numbers[0];
+    }
+    frame.url = location;
+    return frame;
+}
+
+// call tree of sampled stacks; node 0 is the synthetic root
+struct profile_node {
+    profile_frame frame;
+    int parent = -1;
+    uint64_t hits = 0;
+    std::vector<int> children;
+};
+
+// sampling profiler for backend JS. a timer thread raises a flag at the sample
+// rate; the QuickJS interrupt handler, which the interpreter polls between
+// instructions, sees it and records the current stack from a fresh Error. a
+// request that arrives while no JS is running goes stale and is dropped, so
+// idle time does not get charged to whatever runs next.
+class sampling_profiler {
+public:
+    static constexpr size_t MAX_TIMELINE_SAMPLES = 1000000;
+    
+    bool active() const { return active_; }
+    
+    void start(const std::string& path, uint64_t interval_us) {
+        if (active_ || path.empty()) return;
+        path_ = path;
+        interval_ns_ = (interval_us > 0 ? interval_us : 1000) * 1000;
+        nodes_.assign(1, profile_node());
+        nodes_[0].frame.function = "(root)";
+        child_index_.clear();
+        samples_.clear();
+        start_ns_ = uv_hrtime();
+        requested_at_.store(0);
+        
+        active_ = true;
+        sampler_running_.store(true);
+        sampler_ = std::thread([this]() {
+            while (sampler_running_.load()) {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(interval_ns_));
+                requested_at_.store(uv_hrtime(), std::memory_order_release);
+            }
+        });
+    }
+    
+    // logic thread, before the runtime is freed
+    void stop() {
+        if (!active_) return;
+        active_ = false;
+        sampler_running_.store(false);
+        if (sampler_.joinable()) sampler_.join();
+        
+        bool chrome = path_.size() >= 11 && path_.compare(path_.size() - 11, 11, ".cpuprofile") == 0;
+        std::ofstream out(path_, std::ios::binary);
+        if (!out) {
+            std::cerr << "[profile] cannot write " << path_ << std::endl;
+            return;
+        }
+        out << (chrome ? cpuprofile_json() : folded_stacks());
+        std::cerr << "[profile] " << total_samples() << " samples written to " << path_ << std::endl;
+    }
+    
+    // polled from the runtime's interrupt handler while JS is executing
+    void poll(JSContext* ctx) {
+        uint64_t requested = requested_at_.load(std::memory_order_acquire);
+        if (requested == 0) return;
+        requested_at_.store(0, std::memory_order_relaxed);
+        
+        uint64_t now = uv_hrtime();
+        if (now - requested > interval_ns_) return;
+        sample(ctx, now);
+    }
+    
+private:
+
+    void sample(JSContext* ctx, uint64_t now) {
+        std::string all = current_js_stack(ctx);
+        if (!all.empty()) {
+            std::vector<std::string> lines;
+            size_t pos = 0;
+            while (pos < all.size()) {
+                size_t end = all.find('\n', pos);
+                if (end == std::string::npos) end = all.size();
+                if (end > pos) lines.push_back(all.substr(pos, end - pos));
+                pos = end + 1;
+            }
+            
+            // Error.stack is innermost first; the tree is walked from the root
+            int node = 0;
+            for (auto it = lines.rbegin(); it != lines.rend(); ++it) {
+                node = child(node, parse_stack_line(*it));
+            }
+            nodes_[node].hits++;
+            if (samples_.size() < MAX_TIMELINE_SAMPLES) {
+                samples_.push_back({node, now});
+            }
+        }
+    }
+    
+    int child(int parent, const profile_frame& frame) {
+        std::string key = std::to_string(parent) + '\n' + frame.function + '\n' + frame.url + ':' +
+                          std::to_string(frame.line) + ':' + std::to_string(frame.column);
+        auto it = child_index_.find(key);
+        if (it != child_index_.end()) return it->second;
+        
+        int id = (int)nodes_.size();
+        profile_node node;
+        node.frame = frame;
+        node.parent = parent;
+        nodes_.push_back(std::move(node));
+        nodes_[parent].children.push_back(id);
+        child_index_.emplace(std::move(key), id);
+        return id;
+    }
+    
+    uint64_t total_samples() const {
+        uint64_t total = 0;
+        for (const auto& node : nodes_) total += node.hits;
+        return total;
+    }
+    
+    static std::string frame_label(const profile_frame& frame) {
+        std::string label = frame.function.empty() ? "(anonymous)" : frame.function;
+        if (!frame.url.empty()) {
+            label += " (" + frame.url;
+            if (frame.line) label += ":" + std::to_string(frame.line);
+            label += ")";
+        }
+        return label;
+    }
+    
+    // Brendan Gregg's folded format, root first: "a;b;c <samples>"
+    std::string folded_stacks() const {
+        std::string out;
+        for (size_t id = 1; id < nodes_.size(); id++) {
+            if (nodes_[id].hits == 0) continue;
+            std::vector<int> path;
+            for (int n = (int)id; n > 0; n = nodes_[n].parent) path.push_back(n);
+            
+            std::string line;
+            for (auto it = path.rbegin(); it != path.rend(); ++it) {
+                if (!line.empty()) line += ';';
+                for (char c : frame_label(nodes_[*it].frame)) line += (c == ';' || c == ' ') ? '_' : c;
+            }
+            out += line + " " + std::to_string(nodes_[id].hits) + "\n";
+        }
+        return out;
+    }
+    
+    static std::string json_string(const std::string& s) {
+        std::string out = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') { out += '\\'; out += c; }
+            else if ((unsigned char)c < 0x20) out += ' ';
+            else out += c;
+        }
+        return out + "\"";
+    }
+    
+    // Chrome DevTools / speedscope .cpuprofile; node ids are 1-based there
+    std::string cpuprofile_json() const {
+        std::map<std::string, int> script_ids;
+        std::string out = "{\"nodes\":[";
+        for (size_t id = 0; id < nodes_.size(); id++) {
+            const profile_node& node = nodes_[id];
+            auto script = script_ids.emplace(node.frame.url, (int)script_ids.size() + 1).first;
+            if (id) out += ',';
+            out += "{\"id\":" + std::to_string(id + 1) +
+                   ",\"callFrame\":{\"functionName\":" + json_string(node.frame.function) +
+                   ",\"scriptId\":\"" + std::to_string(script->second) + "\"" +
+                   ",\"url\":" + json_string(node.frame.url) +
+                   ",\"lineNumber\":" + std::to_string(node.frame.line - 1) +
+                   ",\"columnNumber\":" + std::to_string(node.frame.column - 1) + "}" +
+                   ",\"hitCount\":" + std::to_string(node.hits) + ",\"children\":[";
+            for (size_t i = 0; i < node.children.size(); i++) {
+                if (i) out += ',';
+                out += std::to_string(node.children[i] + 1);
+            }
+            out += "]}";
+        }
+        
+        uint64_t end_ns = samples_.empty() ? start_ns_ : samples_.back().second;
+        out += "],\"startTime\":" + std::to_string(start_ns_ / 1000) +
+               ",\"endTime\":" + std::to_string(end_ns / 1000) + ",\"samples\":[";
+        for (size_t i = 0; i < samples_.size(); i++) {
+            if (i) out += ',';
+            out += std::to_string(samples_[i].first + 1);
+        }
+        out += "],\"timeDeltas\":[";
+        uint64_t last = start_ns_;
+        for (size_t i = 0; i < samples_.size(); i++) {
+            if (i) out += ',';
+            out += std::to_string((samples_[i].second - last) / 1000);
+            last = samples_[i].second;
+        }
+        out += "]}";
+        return out;
+    }
+    
+    bool active_ = false;
+    std::string path_;
+    uint64_t interval_ns_ = 1000000;
+    uint64_t start_ns_ = 0;
+    std::atomic<uint64_t> requested_at_{0};
+    std::atomic<bool> sampler_running_{false};
+    std::thread sampler_;
+    std::vector<profile_node> nodes_;
+    std::map<std::string, int> child_index_;
+    std::vector<std::pair<int, uint64_t>> samples_;
+};
+
+static sampling_profiler g_profiler;
+
+// VALKYRIE_PROFILE=<file> enables profiling when the app did not ask for it;
+// files ending in .cpuprofile get the Chrome format, anything else folded stacks
+inline std::string profile_path_from_env() {
+    const char* path = getenv("VALKYRIE_PROFILE");
+    return path ? path : "";
+}
+
+inline uint64_t profile_interval_from_env() {
+    const char* us = getenv("VALKYRIE_PROFILE_INTERVAL_US");
+    return us ? strtoull(us, nullptr, 10) : 0;
+}
+
+} // namespace valkyrie
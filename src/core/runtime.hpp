@@ -46,7 +46,9 @@ globalThis.process = {
     platform: 'linux',
     env: {},
     cwd: () => '/',
-    nextTick: (fn) => setTimeout(fn, 0)
+    nextTick: (fn, ...args) => queueMicrotask(() => fn(...args)),
+    memoryUsage: () => native_memory_usage(),
+    dumpMemoryUsage: (path) => native_dump_memory(path)
 };
 
 globalThis.console = {
@@ -143,6 +145,37 @@ globalThis.Buffer = class Buffer extends Uint8Array {
     }
 };
 
+globalThis.valkyrie = {
+    metrics: () => native_metrics(),
+    resetMetrics: () => native_metrics_reset()
+};
+
+// backs valkyrie.invoke() in the UI: handleCommand may return a value or a
+// promise, and either outcome settles the caller's promise by id
+globalThis.__valkyrie_invoke = (id, msg) => {
+    const reply = (status, value) => {
+        let json;
+        try {
+            json = JSON.stringify(value === undefined ? null : value);
+        } catch (e) {
+            status = 1;
+            json = JSON.stringify(String(e));
+        }
+        native_reply(id, status, json);
+    };
+    const fail = (e) => reply(1, e && e.message ? e.message : String(e));
+    
+    if (typeof handleCommand !== 'function') {
+        fail('handleCommand is not defined');
+        return;
+    }
+    try {
+        Promise.resolve(handleCommand(msg)).then((value) => reply(0, value), fail);
+    } catch (e) {
+        fail(e);
+    }
+};
+
 globalThis.module = { exports: {} };
 globalThis.exports = globalThis.module.exports;
 
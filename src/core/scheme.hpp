@@ -0,0 +1,305 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "vfs.hpp"
+#include "mime.hpp"
+#include "bytecode.hpp"
+
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// WebKitGTK lets us answer valkyrie:// requests ourselves; elsewhere pages are
+// assembled from the vfs and handed to set_html
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(VALKYRIE_NO_WEBVIEW)
+    #include <webkit2/webkit2.h>
+    #define VALKYRIE_HAS_APP_SCHEME
+#endif
+
+namespace valkyrie {
+
+constexpr const char* APP_SCHEME = "valkyrie";
+constexpr const char* APP_ORIGIN = "valkyrie://app/";
+// the page can only reach vfs entries under this prefix; backend/ scripts and
+// anything else mounted next to the frontend stay private
+constexpr const char* APP_ASSET_ROOT = "www/";
+
+inline std::string format_etag(uint64_t hash) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "\"%016llx\"", (unsigned long long)hash);
+    return buf;
+}
+
+// If-None-Match may carry a list of tags or "*"
+inline bool etag_matches(const char* header, const std::string& etag) {
+    if (!header) return false;
+    if (strcmp(header, "*") == 0) return true;
+    return strstr(header, etag.c_str()) != nullptr;
+}
+
+enum class range_status { full, partial, unsatisfiable };
+
+// single "bytes=a-b", "bytes=a-" or "bytes=-n" range against `size`; multi-range
+// and malformed headers fall back to the full body, as RFC 9110 allows
+inline range_status parse_byte_range(const char* header, size_t size, size_t& start, size_t& length) {
+    start = 0;
+    length = size;
+    if (!header || strncmp(header, "bytes=", 6) != 0 || strchr(header, ',')) {
+        return range_status::full;
+    }
+    
+    const char* spec = header + 6;
+    const char* dash = strchr(spec, '-');
+    if (!dash) return range_status::full;
+    
+    char* end = nullptr;
+    if (dash == spec) {
+        unsigned long long suffix = strtoull(dash + 1, &end, 10);
+        if (end == dash + 1 || *end) return range_status::full;
+        if (suffix == 0 || size == 0) return range_status::unsatisfiable;
+        length = suffix < size ? (size_t)suffix : size;
+        start = size - length;
+        return range_status::partial;
+    }
+    
+    unsigned long long first = strtoull(spec, &end, 10);
+    if (end != dash) return range_status::full;
+    if (first >= size) return range_status::unsatisfiable;
+    
+    unsigned long long last = size - 1;
+    if (dash[1]) {
+        last = strtoull(dash + 1, &end, 10);
+        if (*end || last < first) return range_status::full;
+        if (last >= size) last = size - 1;
+    }
+    start = (size_t)first;
+    length = (size_t)(last - first + 1);
+    return range_status::partial;
+}
+
+// maps the path of a valkyrie://app/ URL to its vfs key under APP_ASSET_ROOT.
+// keys are matched verbatim, so "../" cannot climb out of the root.
+inline std::string app_scheme_path(const char* raw) {
+    std::string path;
+    for (const char* p = raw ? raw : ""; *p; p++) {
+        if (*p == '%' && isxdigit((unsigned char)p[1]) && isxdigit((unsigned char)p[2])) {
+            char hex[3] = {p[1], p[2], 0};
+            path += (char)strtol(hex, nullptr, 16);
+            p += 2;
+        } else {
+            path += *p;
+        }
+    }
+    while (!path.empty() && path[0] == '/') path.erase(0, 1);
+    if (path.empty() || path.back() == '/') path += "index.html";
+    return APP_ASSET_ROOT + path;
+}
+
+inline bool is_servable(const std::string& path, const vfs::file_entry& entry) {
+    // bytecode is never handed to the UI, even if someone packs it under the root
+    return path.compare(0, strlen(APP_ASSET_ROOT), APP_ASSET_ROOT) == 0 &&
+           entry.mime_type != SCRIPT_BYTECODE_MIME && entry.mime_type != MODULE_BYTECODE_MIME;
+}
+
+// fallback for webviews without a custom scheme: pulls <script src> and
+// <link rel="stylesheet" href> targets that live in the vfs into the page
+inline std::string inline_vfs_assets(std::string html) {
+    auto attribute = [&html](size_t tag_start, size_t tag_end, const char* name) -> std::string {
+        std::string key = std::string(name) + "=\"";
+        size_t pos = html.find(key, tag_start);
+        if (pos == std::string::npos || pos > tag_end) return "";
+        pos += key.size();
+        size_t end = html.find('"', pos);
+        if (end == std::string::npos || end > tag_end) return "";
+        return html.substr(pos, end - pos);
+    };
+    
+    size_t pos = 0;
+    while ((pos = html.find('<', pos)) != std::string::npos) {
+        bool is_script = html.compare(pos, 7, "<script") == 0;
+        bool is_link = html.compare(pos, 5, "<link") == 0;
+        size_t tag_end = html.find('>', pos);
+        if ((!is_script && !is_link) || tag_end == std::string::npos) {
+            pos++;
+            continue;
+        }
+        
+        std::string src = attribute(pos, tag_end, is_script ? "src" : "href");
+        std::string path = app_scheme_path(src.c_str());
+        auto entry = src.empty() ? std::nullopt : vfs::instance().read_file(path);
+        if (!entry || !is_servable(path, *entry) || (is_link && attribute(pos, tag_end, "rel") != "stylesheet")) {
+            pos = tag_end + 1;
+            continue;
+        }
+        
+        size_t replace_end = tag_end + 1;
+        if (is_script) {
+            size_t close = html.find("</script>", tag_end);
+            if (close != std::string::npos) replace_end = close + 9;
+        }
+        std::string inlined = is_script ? "<script>" : "<style>";
+        inlined += entry->text();
+        inlined += is_script ? "</script>" : "</style>";
+        html.replace(pos, replace_end - pos, inlined);
+        pos += inlined.size();
+    }
+    return html;
+}
+
+#ifdef VALKYRIE_HAS_APP_SCHEME
+
+static void finish_app_scheme_error(WebKitURISchemeRequest* request, int code, const std::string& message) {
+    GError* error = g_error_new(G_IO_ERROR, code, "%s", message.c_str());
+    webkit_uri_scheme_request_finish_error(request, error);
+    g_error_free(error);
+}
+
+// runs on the GTK main thread for every valkyrie://app/ request
+static void handle_app_scheme_request(WebKitURISchemeRequest* request, gpointer) {
+    std::string path = app_scheme_path(webkit_uri_scheme_request_get_path(request));
+    auto found = vfs::instance().read_raw(path);
+    bool encoded = false;
+#if defined(VALKYRIE_SCHEME_CONTENT_ENCODING) && WEBKIT_CHECK_VERSION(2, 36, 0)
+    // opt-in for WebKit builds that decode Content-Encoding on scheme responses;
+    // stock WebKitGTK hands the body to the page untouched
+    if (found && !found->encoding.empty()) {
+        SoupMessageHeaders* accept_headers = webkit_uri_scheme_request_get_http_headers(request);
+        const char* accept = accept_headers ? soup_message_headers_get_one(accept_headers, "Accept-Encoding") : nullptr;
+        encoded = accept && strstr(accept, std::string(found->encoding).c_str());
+    }
+#endif
+    if (found && !found->encoding.empty() && !encoded) {
+        found = vfs::instance().read_file(path);
+    }
+    if (!found || !is_servable(path, *found)) {
+        finish_app_scheme_error(request, G_IO_ERROR_NOT_FOUND, "not found: " + path);
+        return;
+    }
+    
+    // the stream reads the entry in place; the heap copy holds a reference until WebKit is done
+    auto* entry = new vfs::file_entry(std::move(*found));
+    std::string mime = entry->mime_type.empty() ? guess_mime_type(path) : std::string(entry->mime_type);
+    size_t size = entry->data.size();
+    size_t start = 0;
+    size_t length = size;
+    
+#if WEBKIT_CHECK_VERSION(2, 36, 0)
+    // each representation gets its own tag; ranges are only offered on the decoded one
+    std::string etag = format_etag(entry->hash);
+    if (encoded) etag.insert(etag.size() - 1, "-" + std::string(entry->encoding));
+    SoupMessageHeaders* request_headers = webkit_uri_scheme_request_get_http_headers(request);
+    const char* if_none_match = request_headers ? soup_message_headers_get_one(request_headers, "If-None-Match") : nullptr;
+    const char* range = request_headers && !encoded ? soup_message_headers_get_one(request_headers, "Range") : nullptr;
+    
+    SoupMessageHeaders* headers = soup_message_headers_new(SOUP_MESSAGE_HEADERS_RESPONSE);
+    soup_message_headers_append(headers, "ETag", etag.c_str());
+    if (encoded) {
+        soup_message_headers_append(headers, "Content-Encoding", std::string(entry->encoding).c_str());
+        soup_message_headers_append(headers, "Vary", "Accept-Encoding");
+    } else {
+        soup_message_headers_append(headers, "Accept-Ranges", "bytes");
+    }
+    // cached copies are revalidated against the ETag, so a rebuilt bundle is never stale
+    soup_message_headers_append(headers, "Cache-Control", "no-cache");
+    
+    unsigned status = 200;
+    if (etag_matches(if_none_match, etag)) {
+        status = 304;
+        length = 0;
+    } else {
+        switch (parse_byte_range(range, size, start, length)) {
+        case range_status::partial: {
+            status = 206;
+            std::string content_range = "bytes " + std::to_string(start) + "-" +
+                                        std::to_string(start + length - 1) + "/" + std::to_string(size);
+            soup_message_headers_append(headers, "Content-Range", content_range.c_str());
+            break;
+        }
+        case range_status::unsatisfiable: {
+            status = 416;
+            start = 0;
+            length = 0;
+            std::string content_range = "bytes */" + std::to_string(size);
+            soup_message_headers_append(headers, "Content-Range", content_range.c_str());
+            break;
+        }
+        case range_status::full:
+            break;
+        }
+    }
+#endif
+    
+    GBytes* bytes = g_bytes_new_with_free_func(entry->data.data() + start, length,
+                                               [](gpointer owner) { delete (vfs::file_entry*)owner; }, entry);
+    GInputStream* stream = g_memory_input_stream_new_from_bytes(bytes);
+    g_bytes_unref(bytes);
+    
+#if WEBKIT_CHECK_VERSION(2, 36, 0)
+    WebKitURISchemeResponse* response = webkit_uri_scheme_response_new(stream, (gint64)length);
+    webkit_uri_scheme_response_set_status(response, status, nullptr);
+    webkit_uri_scheme_response_set_content_type(response, mime.c_str());
+    webkit_uri_scheme_response_set_http_headers(response, headers);
+    webkit_uri_scheme_request_finish_with_response(request, response);
+    g_object_unref(response);
+#else
+    webkit_uri_scheme_request_finish(request, stream, (gint64)length, mime.c_str());
+#endif
+    g_object_unref(stream);
+}
+
+// must run before the first load in the view's web context
+inline void register_app_scheme(void* web_view) {
+    static bool registered = false;
+    if (registered || !web_view) return;
+    registered = true;
+    
+    WebKitWebContext* context = webkit_web_view_get_context(WEBKIT_WEB_VIEW(web_view));
+    webkit_web_context_register_uri_scheme(context, APP_SCHEME, handle_app_scheme_request, nullptr, nullptr);
+    
+    // a secure, CORS-enabled origin so fetch(), modules and workers behave as they would over https
+    WebKitSecurityManager* security = webkit_web_context_get_security_manager(context);
+    webkit_security_manager_register_uri_scheme_as_secure(security, APP_SCHEME);
+    webkit_security_manager_register_uri_scheme_as_cors_enabled(security, APP_SCHEME);
+}
+
+#endif
+
+} // namespace valkyrie
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <uv.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace valkyrie {
+
+// Chrome trace_event recorder (load the output in Perfetto or chrome://tracing).
+// every thread records into one mutex-protected buffer; when tracing is off
+// each call site costs one relaxed load.
+class trace_recorder {
+public:
+    static constexpr size_t MAX_EVENTS = 2000000;
+    
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    
+    void start(const std::string& path) {
+        if (path.empty() || enabled()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        path_ = path;
+        events_.clear();
+        dropped_ = 0;
+        enabled_.store(true);
+    }
+    
+    void stop() {
+        if (!enabled()) return;
+        enabled_.store(false);
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::ofstream out(path_, std::ios::binary);
+        if (!out) {
+            std::cerr << "[trace] cannot write " << path_ << std::endl;
+            return;
+        }
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        for (size_t i = 0; i < events_.size(); i++) {
+            out << events_[i] << (i + 1 < events_.size() ? ",\n" : "\n");
+        }
+        out << "]}\n";
+        std::cerr << "[trace] " << events_.size() << " events written to " << path_;
+        if (dropped_) std::cerr << " (" << dropped_ << " dropped)";
+        std::cerr << std::endl;
+        events_.clear();
+    }
+    
+    static uint64_t now_us() { return uv_hrtime() / 1000; }
+    
+    void complete(const char* name, const char* cat, uint64_t ts, uint64_t dur, const std::string& args = "") {
+        std::string event = header(name, cat, "X", ts);
+        event += ",\"dur\":" + std::to_string(dur);
+        if (!args.empty()) event += ",\"args\":" + args;
+        push(event + "}");
+    }
+    
+    // flow arrows connect a slice on one thread to a slice on another
+    void flow_start(const char* name, uint64_t id) {
+        push(header(name, "flow", "s", now_us()) + ",\"id\":\"" + hex(id) + "\"}");
+    }
+    
+    void flow_end(const char* name, uint64_t id) {
+        push(header(name, "flow", "f", now_us()) + ",\"bp\":\"e\",\"id\":\"" + hex(id) + "\"}");
+    }
+    
+    // nestable async spans for work that hops between callbacks
+    void async_begin(const char* name, const char* cat, uint64_t id, const std::string& args = "") {
+        std::string event = header(name, cat, "b", now_us()) + ",\"id\":\"" + hex(id) + "\"";
+        if (!args.empty()) event += ",\"args\":" + args;
+        push(event + "}");
+    }
+    
+    void async_end(const char* name, const char* cat, uint64_t id) {
+        push(header(name, cat, "e", now_us()) + ",\"id\":\"" + hex(id) + "\"}");
+    }
+    
+    void name_thread(const char* name) {
+        push("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(thread_id()) +
+             ",\"args\":{\"name\":\"" + std::string(name) + "\"}}");
+    }
+    
+    uint64_t next_id() { return id_counter_.fetch_add(1, std::memory_order_relaxed) + 1; }
+    
+    static std::string arg(const char* key, const std::string& value) {
+        std::string out = "{\"";
+        out += key;
+        out += "\":\"";
+        for (char c : value) {
+            if (c == '"' || c == '\\') { out += '\\'; out += c; }
+            else if ((unsigned char)c < 0x20) out += ' ';
+            else out += c;
+        }
+        return out + "\"}";
+    }
+    
+    static std::string arg(const char* key, uint64_t value) {
+        return std::string("{\"") + key + "\":" + std::to_string(value) + "}";
+    }
+    
+private:
+    static int thread_id() {
+        static std::atomic<int> counter{0};
+        thread_local int id = ++counter;
+        return id;
+    }
+    
+    static std::string hex(uint64_t id) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), "0x%llx", (unsigned long long)id);
+        return buf;
+    }
+    
+    static std::string header(const char* name, const char* cat, const char* ph, uint64_t ts) {
+        return std::string("{\"name\":\"") + name + "\",\"cat\":\"" + cat + "\",\"ph\":\"" + ph +
+               "\",\"ts\":" + std::to_string(ts) + ",\"pid\":1,\"tid\":" + std::to_string(thread_id());
+    }
+    
+    void push(std::string event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!enabled()) return;
+        if (events_.size() >= MAX_EVENTS) {
+            dropped_++;
+            return;
+        }
+        events_.push_back(std::move(event));
+    }
+    
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint64_t> id_counter_{0};
+    std::mutex mutex_;
+    std::string path_;
+    std::vector<std::string> events_;
+    uint64_t dropped_ = 0;
+};
+
+static trace_recorder g_trace;
+
+// records a complete ("X") event covering its own lifetime
+class trace_span {
+public:
+    trace_span(const char* name, const char* cat, std::string args = "")
+        : name_(name), cat_(cat), args_(std::move(args)), start_(g_trace.enabled() ? trace_recorder::now_us() : 0) {}
+    
+    ~trace_span() {
+        if (start_ && g_trace.enabled()) {
+            g_trace.complete(name_, cat_, start_, trace_recorder::now_us() - start_, args_);
+        }
+    }
+    
+    trace_span(const trace_span&) = delete;
+    trace_span& operator=(const trace_span&) = delete;
+    
+private:
+    const char* name_;
+    const char* cat_;
+    std::string args_;
+    uint64_t start_;
+};
+
+inline std::string trace_path_from_env() {
+    const char* path = getenv("VALKYRIE_TRACE");
+    return path ? path : "";
+}
+
+} // namespace valkyrie
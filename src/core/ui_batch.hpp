@@ -0,0 +1,184 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "ipc.hpp"
+#include "trace.hpp"
+#include <uv.h>
+#include <cstdint>
+#include <string>
+
+namespace valkyrie {
+
+constexpr uint64_t UI_BATCH_DEFAULT_INTERVAL_MS = 16;
+
+// installed once per page with webview init; each flush only calls it.
+// walks the batch: resolves dotted handler names the way `window.<event>`
+// did, decodes binary entries, and isolates handler errors
+static const char* UI_BATCH_DISPATCHER =
+    "window.__valkyrieBatch=function(m){for(var i=0;i<m.length;i++){"
+    "var o=window,f=window,p=m[i][0].split('.');for(var k=0;k<p.length&&f;k++){o=f;f=f[p[k]];}"
+    "if(typeof f!=='function')continue;var d=m[i][1];"
+    "if(m[i][2]){var s=atob(d),b=new Uint8Array(s.length);"
+    "for(var j=0;j<s.length;j++)b[j]=s.charCodeAt(j);d=b.buffer;}"
+    "try{f.call(o,d);}catch(e){console.error(e);}}};";
+
+constexpr const char* UI_BATCH_CALL = "window.__valkyrieBatch([";
+
+// appends `s` as a double-quoted JS string literal
+inline void append_js_string(std::string& out, const char* s, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '<': out += "\\x3c"; break; // keeps "</script>" inert
+            default:
+                if (c < 0x20) {
+                    out += "\\x";
+                    out += hex[c >> 4];
+                    out += hex[c & 15];
+                } else if (c == 0xE2 && i + 2 < len && (unsigned char)s[i + 1] == 0x80 &&
+                           ((unsigned char)s[i + 2] == 0xA8 || (unsigned char)s[i + 2] == 0xA9)) {
+                    // U+2028/U+2029 end a line inside pre-ES2019 string literals
+                    out += (unsigned char)s[i + 2] == 0xA8 ? "\\u2028" : "\\u2029";
+                    i += 2;
+                } else {
+                    out += (char)c;
+                }
+        }
+    }
+    out += '"';
+}
+
+// backend->UI messages, coalesced into one webview eval per frame interval.
+// logic thread only; a priority message flushes everything queued before it
+// so delivery order is preserved.
+class ui_batcher {
+public:
+    void init(uv_loop_t* loop, uint64_t interval_ms) {
+        uv_timer_init(loop, &timer_);
+        timer_.data = this;
+        interval_ms_ = interval_ms;
+        ready_ = true;
+    }
+    
+    void close() {
+        if (!ready_) return;
+        flush();
+        ready_ = false;
+        uv_close((uv_handle_t*)&timer_, nullptr);
+    }
+    
+    void enqueue(const std::string& event, const char* payload, size_t len, bool binary, bool priority) {
+        batch_ += count_ ? ",[" : "[";
+        append_js_string(batch_, event.data(), event.size());
+        batch_ += ',';
+        if (binary) {
+            // base64 is already a safe literal body
+            batch_ += '"';
+            batch_.append(payload, len);
+            batch_ += "\",1]";
+        } else {
+            append_js_string(batch_, payload, len);
+            batch_ += ']';
+        }
+        count_++;
+        
+        if (priority || interval_ms_ == 0 || !ready_) {
+            flush();
+        } else if (!armed_) {
+            uv_timer_start(&timer_, flush_cb, interval_ms_, 0);
+            armed_ = true;
+        }
+    }
+    
+    void flush() {
+        if (armed_) {
+            uv_timer_stop(&timer_);
+            armed_ = false;
+        }
+        if (count_ == 0) return;
+        
+        trace_span span("ui_flush", "ipc", g_trace.enabled() ? trace_recorder::arg("messages", count_) : "");
+        std::string js = UI_BATCH_CALL;
+        js.reserve(js.size() + batch_.size() + 4);
+        js += batch_;
+        js += "]);";
+        batch_.clear();
+        count_ = 0;
+        
+        if (!g_webview_ptr) return;
+        uint64_t flow = 0;
+        if (g_trace.enabled()) {
+            flow = g_trace.next_id();
+            g_trace.flow_start("sendToUI", flow);
+        }
+        g_webview_ptr->dispatch([js = std::move(js), flow]() {
+            trace_span span("sendToUI.eval", "ui");
+            if (flow) g_trace.flow_end("sendToUI", flow);
+            if (g_webview_ptr) {
+                g_webview_ptr->eval(js);
+            }
+        });
+    }
+    
+private:
+    static void flush_cb(uv_timer_t* handle) {
+        ui_batcher* self = (ui_batcher*)handle->data;
+        self->armed_ = false;
+        self->flush();
+    }
+    
+    uv_timer_t timer_;
+    uint64_t interval_ms_ = UI_BATCH_DEFAULT_INTERVAL_MS;
+    bool ready_ = false;
+    bool armed_ = false;
+    std::string batch_;
+    uint64_t count_ = 0;
+};
+
+static ui_batcher g_ui_batch;
+
+} // namespace valkyrie
@@ -38,19 +38,46 @@
 
 #pragma once
 
+#include "hash.hpp"
+#include "embedded.hpp"
+#include "pack.hpp"
 #include <string>
+#include <string_view>
+#include <span>
 #include <vector>
 #include <unordered_map>
+#include <shared_mutex>
 #include <mutex>
+#include <memory>
 #include <optional>
+#include <functional>
+#include <array>
+#include <atomic>
+#include <list>
+
+#ifdef VALKYRIE_ZSTD
+    #include <zstd.h>
+#endif
 
 namespace valkyrie {
 
+// decoded copies of compressed entries kept around for repeat reads
+constexpr size_t VFS_DEFAULT_DECODED_CACHE_BYTES = 32 * 1024 * 1024;
+
 class vfs {
 public:
+    // immutable view of a registered file. copies are cheap and keep the bytes
+    // alive through `owner` even if the path is re-registered; entries backed
+    // by static storage have no owner. data[size] is always a NUL, so sources
+    // go straight to JS_Eval.
     struct file_entry {
-        std::vector<uint8_t> data;
-        std::string mime_type;
+        std::span<const uint8_t> data;
+        std::string_view mime_type;
+        uint64_t hash = 0; // content hash, used as the ETag when served over valkyrie://
+        std::shared_ptr<const void> owner;
+        std::string_view encoding; // only set by read_raw(); read_file() always returns decoded bytes
+        
+        std::string_view text() const { return {(const char*)data.data(), data.size()}; }
     };
 
     static vfs& instance() {
@@ -58,53 +85,232 @@ public:
         return inst;
     }
 
+    // copies `data` into refcounted storage
     void register_file(const std::string& path, const uint8_t* data, size_t len, const std::string& mime = "") {
-        std::lock_guard<std::mutex> lock(mutex_);
-        files_[path] = file_entry{{data, data + len}, mime};
+        auto storage = std::make_shared<file_storage>();
+        storage->bytes.reserve(len + 1);
+        storage->bytes.assign(data, data + len);
+        storage->bytes.push_back(0);
+        storage->mime = mime;
+        
+        file_entry entry{{storage->bytes.data(), len}, storage->mime, fnv1a_hash(data, len), storage, {}};
+        std::unique_lock lock(mutex_);
+        files_.insert_or_assign(path, std::move(entry));
+        file_count_.store(files_.size(), std::memory_order_release);
     }
 
     void register_file(const std::string& path, const std::string& data, const std::string& mime = "") {
         register_file(path, (const uint8_t*)data.data(), data.size(), mime);
     }
 
-    std::optional<file_entry> read_file(const std::string& path) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = files_.find(path);
-        if (it != files_.end()) {
-            return it->second;
+    // references `data` in place; it must outlive the vfs and have a NUL at data[len],
+    // which holds for arrays generated by `valkyrie build`
+    void register_static(const std::string& path, const uint8_t* data, size_t len, const char* mime = "") {
+        std::unique_lock lock(mutex_);
+        files_.insert_or_assign(path, file_entry{{data, len}, mime, fnv1a_hash(data, len), nullptr, {}});
+        file_count_.store(files_.size(), std::memory_order_release);
+    }
+
+    // makes a generated table visible; later mounts shadow earlier ones and
+    // both shadow registered files. `table` must outlive the vfs.
+    bool mount(const embedded_table& table) {
+        std::unique_lock lock(mutex_);
+        size_t n = table_count_.load(std::memory_order_relaxed);
+        if (n == tables_.size()) return false;
+        tables_[n].store(&table, std::memory_order_relaxed);
+        table_count_.store(n + 1, std::memory_order_release);
+        return true;
+    }
+
+    // maps the asset pack at the end of `path` read-only and mounts its index;
+    // nothing is copied and the kernel pages assets in as they are read
+    bool mount_pack(const std::string& path) {
+        auto pack = std::make_unique<asset_pack>();
+        if (!pack->open(path)) return false;
+        const embedded_table& table = pack->table();
+        {
+            std::unique_lock lock(mutex_);
+            packs_.push_back(std::move(pack));
         }
-        if (path[0] == '/') {
-            it = files_.find(path.substr(1));
-            if (it != files_.end()) {
-                return it->second;
-            }
+        return mount(table);
+    }
+
+    // the pack `valkyrie build` appended to this executable, or <executable>.pack beside it
+    bool mount_self() {
+        std::string exe = executable_path();
+        return !exe.empty() && (mount_pack(exe) || mount_pack(exe + ".pack"));
+    }
+
+    std::optional<file_entry> read_file(std::string_view path) const {
+        auto entry = read_raw(path);
+        if (entry && !entry->encoding.empty()) {
+            return decode(*entry);
+        }
+        return entry;
+    }
+
+    // the entry as stored, possibly still compressed; see file_entry::encoding
+    std::optional<file_entry> read_raw(std::string_view path) const {
+        if (auto entry = find_entry(path)) {
+            return entry;
+        }
+        if (!path.empty() && path[0] == '/') {
+            return find_entry(path.substr(1));
         }
         return std::nullopt;
     }
 
-    bool exists(const std::string& path) {
-        std::lock_guard<std::mutex> lock(mutex_);
+    // bounds the decoded copies of compressed entries; entries larger than the
+    // limit are decoded on every read
+    void set_decoded_cache_limit(size_t bytes) {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        cache_limit_ = bytes;
+        evict_locked();
+    }
+
+    size_t decoded_cache_size() const {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        return cache_bytes_;
+    }
+
+    bool exists(std::string_view path) const {
+        if (find_embedded(path)) return true;
+        if (file_count_.load(std::memory_order_acquire) == 0) return false;
+        std::shared_lock lock(mutex_);
         return files_.find(path) != files_.end();
     }
 
-    std::vector<std::string> list_files() {
-        std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> list_files() const {
+        std::shared_lock lock(mutex_);
         std::vector<std::string> result;
         result.reserve(files_.size());
         for (const auto& [path, _] : files_) {
-            result.push_back(path);
+            if (!find_embedded(path)) result.push_back(path);
+        }
+        size_t tables = table_count_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < tables; i++) {
+            const embedded_table* table = tables_[i].load(std::memory_order_relaxed);
+            for (size_t j = 0; j < table->count; j++) {
+                std::string_view path = table->files[j].path;
+                if (find_embedded(path) == &table->files[j]) result.emplace_back(path);
+            }
         }
         return result;
     }
 
 private:
+    struct file_storage {
+        std::vector<uint8_t> bytes;
+        std::string mime;
+    };
+    
+    // lets lookups take a string_view without building a std::string key
+    struct path_hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view path) const { return std::hash<std::string_view>{}(path); }
+    };
+    
+    static constexpr size_t MAX_EMBEDDED_TABLES = 16;
+    
     vfs() = default;
-    std::unordered_map<std::string, file_entry> files_;
-    std::mutex mutex_;
+    
+    const embedded_file* find_embedded(std::string_view path) const {
+        size_t tables = table_count_.load(std::memory_order_acquire);
+        for (size_t i = tables; i-- > 0;) {
+            if (const embedded_file* file = tables_[i].load(std::memory_order_relaxed)->find(path)) {
+                return file;
+            }
+        }
+        return nullptr;
+    }
+    
+    std::optional<file_entry> find_entry(std::string_view path) const {
+        if (const embedded_file* file = find_embedded(path)) {
+            return file_entry{{file->data, file->size}, file->mime_type, file->hash, nullptr, file->encoding};
+        }
+        // apps that only embed never take the lock
+        if (file_count_.load(std::memory_order_acquire) == 0) return std::nullopt;
+        std::shared_lock lock(mutex_);
+        auto it = files_.find(path);
+        if (it != files_.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+    
+    using decoded_bytes = std::shared_ptr<const std::vector<uint8_t>>;
+    
+    // compressed payloads live in static storage, so their address identifies them
+    std::optional<file_entry> decode(const file_entry& raw) const {
+        const uint8_t* key = raw.data.data();
+        decoded_bytes bytes;
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            auto it = cache_index_.find(key);
+            if (it != cache_index_.end()) {
+                cache_.splice(cache_.begin(), cache_, it->second);
+                bytes = it->second->second;
+            }
+        }
+        
+        if (!bytes) {
+            bytes = decompress(raw);
+            if (!bytes) return std::nullopt;
+            
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            if (bytes->size() <= cache_limit_ && !cache_index_.count(key)) {
+                cache_.emplace_front(key, bytes);
+                cache_index_[key] = cache_.begin();
+                cache_bytes_ += bytes->size();
+                evict_locked();
+            }
+        }
+        
+        // the trailing NUL is not part of the content
+        return file_entry{{bytes->data(), bytes->size() - 1}, raw.mime_type, raw.hash, bytes, {}};
+    }
+    
+    static decoded_bytes decompress(const file_entry& raw) {
+#ifdef VALKYRIE_ZSTD
+        if (raw.encoding == "zstd") {
+            unsigned long long size = ZSTD_getFrameContentSize(raw.data.data(), raw.data.size());
+            if (size == ZSTD_CONTENTSIZE_ERROR || size == ZSTD_CONTENTSIZE_UNKNOWN) return nullptr;
+            
+            auto bytes = std::make_shared<std::vector<uint8_t>>(size + 1);
+            size_t written = ZSTD_decompress(bytes->data(), size, raw.data.data(), raw.data.size());
+            if (ZSTD_isError(written) || written != size) return nullptr;
+            (*bytes)[size] = 0;
+            return bytes;
+        }
+#endif
+        return nullptr;
+    }
+    
+    void evict_locked() const {
+        while (cache_bytes_ > cache_limit_ && !cache_.empty()) {
+            cache_bytes_ -= cache_.back().second->size();
+            cache_index_.erase(cache_.back().first);
+            cache_.pop_back();
+        }
+    }
+    
+    std::unordered_map<std::string, file_entry, path_hash, std::equal_to<>> files_;
+    mutable std::shared_mutex mutex_;
+    
+    // decoded compressed entries, most recently used first; readers keep evicted buffers alive
+    mutable std::list<std::pair<const uint8_t*, decoded_bytes>> cache_;
+    mutable std::unordered_map<const uint8_t*, decltype(cache_)::iterator> cache_index_;
+    mutable size_t cache_bytes_ = 0;
+    size_t cache_limit_ = VFS_DEFAULT_DECODED_CACHE_BYTES;
+    mutable std::mutex cache_mutex_;
+    std::atomic<size_t> file_count_{0};
+    std::array<std::atomic<const embedded_table*>, MAX_EMBEDDED_TABLES> tables_{};
+    std::vector<std::unique_ptr<asset_pack>> packs_;
+    std::atomic<size_t> table_count_{0};
 };
 
 #define VFS_REGISTER(path, data) \
-    valkyrie::vfs::instance().register_file(path, data, sizeof(data) - 1)
+    valkyrie::vfs::instance().register_static(path, (const uint8_t*)(data), sizeof(data) - 1)
 
 #define VFS_REGISTER_STRING(path, str) \
     valkyrie::vfs::instance().register_file(path, str)
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "errors.hpp"
+#include "metrics.hpp"
+#include <quickjs/quickjs.h>
+#include <uv.h>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+
+namespace valkyrie {
+
+struct long_task_report {
+    const char* category;
+    double elapsed_ms;
+    double budget_ms;
+    bool aborted;
+    std::string stack;
+    
+    std::string to_json() const {
+        std::string out = "{\"category\":\"" + std::string(category) + "\"" +
+                          ",\"elapsedMs\":" + std::to_string(elapsed_ms) +
+                          ",\"budgetMs\":" + std::to_string(budget_ms) +
+                          ",\"aborted\":" + (aborted ? "true" : "false") + ",\"stack\":\"";
+        for (char c : stack) {
+            if (c == '"' || c == '\\') { out += '\\'; out += c; }
+            else if (c == '\n') out += "\\n";
+            else if ((unsigned char)c < 0x20) out += ' ';
+            else out += c;
+        }
+        return out + "\"}";
+    }
+};
+
+// flags macrotasks (IPC dispatch, timers, socket/http callbacks, posted tasks)
+// that keep the logic thread busy past a budget. runs inside the interrupt
+// handler, so it only sees tasks that are executing JS; each task is reported
+// once, and with abort enabled the interpreter is told to unwind it.
+class long_task_watchdog {
+public:
+    void configure(uint64_t budget_ms, bool abort) {
+        budget_ns_ = budget_ms * 1000000;
+        abort_ = abort;
+        reported_sequence_ = 0;
+    }
+    
+    bool enabled() const { return budget_ns_ != 0; }
+    
+    // runs on the logic thread with the offending stack still live
+    std::function<void(const long_task_report&)> on_long_task;
+    
+    // non-zero makes QuickJS throw an uncatchable "interrupted" error
+    int poll(JSContext* ctx) {
+        if (!budget_ns_ || !g_current_task.start) return 0;
+        
+        uint64_t elapsed = uv_hrtime() - g_current_task.start;
+        if (elapsed < budget_ns_) return 0;
+        
+        if (reported_sequence_ != g_current_task.sequence) {
+            reported_sequence_ = g_current_task.sequence;
+            
+            long_task_report report{
+                METRIC_CATEGORY_NAMES[(int)g_current_task.category],
+                elapsed / 1e6,
+                budget_ns_ / 1e6,
+                abort_,
+                current_js_stack(ctx),
+            };
+            std::cerr << "[watchdog] " << report.category << " task running for " << report.elapsed_ms
+                      << " ms (budget " << report.budget_ms << " ms)" << (abort_ ? ", aborting" : "") << "\n"
+                      << report.stack << std::endl;
+            if (on_long_task) on_long_task(report);
+        }
+        if (!abort_) return 0;
+        
+        // the uncatchable error unwinds only the running call. whatever the
+        // callback does next (microtasks, queued ipc) gets a budget of its own
+        // instead of being interrupted on the spot.
+        g_current_task.start = uv_hrtime();
+        g_current_task.sequence++;
+        return 1;
+    }
+    
+private:
+    uint64_t budget_ns_ = 0;
+    bool abort_ = false;
+    uint64_t reported_sequence_ = 0;
+};
+
+static long_task_watchdog g_watchdog;
+
+} // namespace valkyrie
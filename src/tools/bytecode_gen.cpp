@@ -0,0 +1,95 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// build-time helper: compiles RUNTIME_JS to QuickJS bytecode and writes it
+// out as a header so the engine can skip parsing the runtime on startup.
+//
+//   valkyrie_bytecode_gen <output.h>
+
+#include "src/core/runtime.hpp"
+#include "src/core/bytecode.hpp"
+#include <quickjs/quickjs.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace valkyrie;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: valkyrie_bytecode_gen <output.h>" << std::endl;
+        return 1;
+    }
+    
+    JSRuntime* rt = JS_NewRuntime();
+    JSContext* ctx = JS_NewContext(rt);
+    
+    std::vector<uint8_t> bytecode;
+    std::string error;
+    bool ok = compile_to_bytecode(ctx, RUNTIME_JS, strlen(RUNTIME_JS), "<runtime>", JS_EVAL_TYPE_GLOBAL, bytecode, &error);
+    
+    JS_FreeContext(ctx);
+    JS_FreeRuntime(rt);
+    
+    if (!ok) {
+        std::cerr << "error: failed to compile RUNTIME_JS: " << error << std::endl;
+        return 1;
+    }
+    
+    std::ofstream out(argv[1]);
+    if (!out) {
+        std::cerr << "error: cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+    
+    out << "// generated by valkyrie_bytecode_gen from src/core/runtime.hpp, do not edit\n";
+    out << "#pragma once\n\n";
+    out << "#include <cstdint>\n#include <cstddef>\n\n";
+    out << "namespace valkyrie {\n\n";
+    out << "static const uint64_t RUNTIME_BYTECODE_SOURCE_HASH = 0x" << std::hex
+        << fnv1a_hash(RUNTIME_JS, strlen(RUNTIME_JS)) << "ull;\n" << std::dec;
+    out << "static const size_t RUNTIME_BYTECODE_SIZE = " << bytecode.size() << ";\n";
+    out << "static const uint8_t RUNTIME_BYTECODE[] = {";
+    for (size_t i = 0; i < bytecode.size(); i++) {
+        if (i % 16 == 0) out << "\n    ";
+        out << (int)bytecode[i] << ",";
+    }
+    out << "\n};\n\n} // namespace valkyrie\n";
+    
+    return out.good() ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// writes asset packs with build_asset_pack, appends them to a stand-in binary
+// and maps them back through vfs::mount_pack. damaged packs (cut short, bad
+// magic, offsets pointing outside the pack) must be refused, not mounted.
+
+#include "cli/embed.hpp"
+#include "core/vfs.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static const char* PACK_PATH = "asset_pack_test.bin";
+
+static bool write_binary(const std::string& contents) {
+    std::ofstream out(PACK_PATH, std::ios::binary | std::ios::trunc);
+    out << contents;
+    return out.good();
+}
+
+// an odd-sized "executable" followed by the pack, as build_app leaves it
+static bool write_app(const std::string& pack) {
+    return write_binary(std::string(1001, '\x7f')) && append_asset_pack(PACK_PATH, pack);
+}
+
+static std::string read_binary() {
+    std::ifstream in(PACK_PATH, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static bool opens(const std::string& contents) {
+    if (!write_binary(contents)) return false;
+    valkyrie::asset_pack pack;
+    return pack.open(PACK_PATH);
+}
+
+static bool check_corrupt(const char* what, const std::string& contents) {
+    if (opens(contents)) {
+        std::fprintf(stderr, "asset_pack: a pack with %s was accepted\n", what);
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    std::vector<asset_file> files = {
+        {"www/index.html", "<!DOCTYPE html><title>pack</title>"},
+        {"www/bundle.js", std::string(4096, 'x') + "console.log(1);"},
+        {"www/empty.txt", ""},
+        {"backend/main.js", "function handleCommand(msg) {}", "application/javascript"},
+        {"www/logo.bin", std::string("\0\1\2\3\0", 5), "application/octet-stream"},
+    };
+    
+    std::string pack;
+    if (!build_asset_pack(files, false, pack) || !write_app(pack)) {
+        std::fprintf(stderr, "asset_pack: could not write the pack\n");
+        return 1;
+    }
+    
+    auto& vfs = valkyrie::vfs::instance();
+    if (!vfs.mount_pack(PACK_PATH)) {
+        std::fprintf(stderr, "asset_pack: a freshly built pack did not mount\n");
+        return 1;
+    }
+    for (const auto& file : files) {
+        auto entry = vfs.read_file(file.path);
+        if (!entry || entry->text() != file.data || entry->mime_type != asset_mime(file) ||
+            entry->hash != valkyrie::fnv1a_hash(file.data.data(), file.data.size())) {
+            std::fprintf(stderr, "asset_pack: %s did not round-trip\n", file.path.c_str());
+            return 1;
+        }
+        // blobs are NUL-terminated and aligned for in-place use
+        if (entry->data.data()[entry->data.size()] != 0 ||
+            (uintptr_t)entry->data.data() % valkyrie::PACK_ALIGNMENT != 0) {
+            std::fprintf(stderr, "asset_pack: %s is not aligned or not NUL-terminated\n", file.path.c_str());
+            return 1;
+        }
+    }
+    if (vfs.exists("www/missing.js")) {
+        std::fprintf(stderr, "asset_pack: a path outside the pack was found\n");
+        return 1;
+    }
+    
+    std::string empty;
+    if (!build_asset_pack({}, false, empty) || !opens(empty)) {
+        std::fprintf(stderr, "asset_pack: an empty pack did not open\n");
+        return 1;
+    }
+    
+    write_app(pack);
+    std::string app = read_binary();
+    size_t trailer_at = app.size() - sizeof(valkyrie::pack_trailer);
+    valkyrie::pack_trailer trailer;
+    memcpy(&trailer, app.data() + trailer_at, sizeof(trailer));
+    auto with_trailer = [&](valkyrie::pack_trailer changed) {
+        std::string copy = app;
+        memcpy(copy.data() + trailer_at, &changed, sizeof(changed));
+        return copy;
+    };
+    
+    bool ok = true;
+    ok &= check_corrupt("its last byte cut off", app.substr(0, app.size() - 1));
+    ok &= check_corrupt("its start cut off", app.substr(app.size() - pack.size() / 2));
+    ok &= check_corrupt("only a trailer", app.substr(trailer_at));
+    
+    valkyrie::pack_trailer bad = trailer;
+    bad.magic[7] = '2';
+    ok &= check_corrupt("a bad magic", with_trailer(bad));
+    bad = trailer;
+    bad.pack_size = app.size() + 1;
+    ok &= check_corrupt("a size larger than the file", with_trailer(bad));
+    bad = trailer;
+    bad.index_offset = trailer.pack_size;
+    ok &= check_corrupt("an index past the trailer", with_trailer(bad));
+    bad = trailer;
+    bad.index_size = trailer.index_size + 64;
+    ok &= check_corrupt("an index running into the trailer", with_trailer(bad));
+    
+    // first entry's blob pointed past the index
+    size_t pack_start = app.size() - trailer.pack_size;
+    size_t index_at = pack_start + trailer.index_offset;
+    valkyrie::pack_index_header header;
+    memcpy(&header, app.data() + index_at, sizeof(header));
+    std::string copy = app;
+    uint64_t past_index = trailer.index_offset + 8;
+    memcpy(copy.data() + index_at + valkyrie::pack_entries_offset(header.bucket_count), &past_index, sizeof(past_index));
+    ok &= check_corrupt("a blob offset past the index", copy);
+    
+    std::remove(PACK_PATH);
+    if (!ok) return 1;
+    std::printf("asset_pack: round trip matched and damaged packs were refused\n");
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// zstd entries in an asset pack are decoded on read and kept in an LRU bounded
+// by set_decoded_cache_limit. checks the decoded bytes, which entry is evicted
+// at limits just above and below what the cache holds, and that readers keep
+// evicted buffers alive.
+
+#include "cli/embed.hpp"
+#include "core/vfs.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static const char* PACK_PATH = "decoded_cache_test.pack";
+static constexpr size_t FILE_SIZE = 8192;
+// what one decoded entry costs the cache, its trailing NUL included
+static constexpr size_t DECODED_SIZE = FILE_SIZE + 1;
+
+static std::string compressible(char seed) {
+    std::string text;
+    while (text.size() < FILE_SIZE) text += std::string("let value = '") + seed + "';\n";
+    text.resize(FILE_SIZE);
+    return text;
+}
+
+static bool fail(const char* message) {
+    std::fprintf(stderr, "decoded_cache: %s\n", message);
+    return false;
+}
+
+static bool run() {
+    std::vector<asset_file> files = {
+        {"www/a.js", compressible('a')},
+        {"www/b.js", compressible('b')},
+        {"www/c.js", compressible('c')},
+        {"www/small.js", "tiny"},
+    };
+    
+    std::string pack;
+    if (!build_asset_pack(files, true, pack)) return fail("could not build the pack");
+    {
+        std::ofstream out(PACK_PATH, std::ios::binary | std::ios::trunc);
+        out << pack;
+    }
+    auto& vfs = valkyrie::vfs::instance();
+    if (!vfs.mount_pack(PACK_PATH)) return fail("the compressed pack did not mount");
+    
+    for (const auto& file : files) {
+        auto raw = vfs.read_raw(file.path);
+        bool expect_zstd = file.data.size() >= 512;
+        if (!raw || (raw->encoding == "zstd") != expect_zstd) return fail("an entry has the wrong encoding");
+        if (expect_zstd && raw->data.size() >= file.data.size()) return fail("a zstd entry did not shrink");
+    }
+    
+    auto read = [&vfs](const char* path) { return vfs.read_file(path); };
+    auto same_buffer = [](const std::optional<valkyrie::vfs::file_entry>& a,
+                          const std::optional<valkyrie::vfs::file_entry>& b) {
+        return a && b && a->data.data() == b->data.data();
+    };
+    
+    // nothing fits: every read decodes again and nothing is retained
+    vfs.set_decoded_cache_limit(0);
+    auto a0 = read("www/a.js");
+    if (!a0 || a0->text() != files[0].data || a0->data.data()[a0->data.size()] != 0) {
+        return fail("www/a.js decoded to the wrong bytes");
+    }
+    if (vfs.decoded_cache_size() != 0) return fail("an entry was cached with a zero limit");
+    if (same_buffer(a0, read("www/a.js"))) return fail("an entry larger than the limit was reused");
+    
+    // exactly one entry fits
+    vfs.set_decoded_cache_limit(DECODED_SIZE);
+    auto a1 = read("www/a.js");
+    if (vfs.decoded_cache_size() != DECODED_SIZE) return fail("an entry the size of the limit was not cached");
+    if (!same_buffer(a1, read("www/a.js"))) return fail("a cached entry was decoded again");
+    auto b1 = read("www/b.js");
+    if (vfs.decoded_cache_size() != DECODED_SIZE) return fail("the cache grew past its limit");
+    if (same_buffer(a1, read("www/a.js"))) return fail("www/a.js was not evicted by www/b.js");
+    
+    // one byte short of two entries still holds only one
+    vfs.set_decoded_cache_limit(0);
+    vfs.set_decoded_cache_limit(2 * DECODED_SIZE - 1);
+    read("www/a.js");
+    read("www/b.js");
+    if (vfs.decoded_cache_size() != DECODED_SIZE) return fail("two entries were kept one byte over the limit");
+    
+    // two fit; touching a makes b the least recently used when c arrives
+    vfs.set_decoded_cache_limit(0);
+    vfs.set_decoded_cache_limit(2 * DECODED_SIZE);
+    auto a2 = read("www/a.js");
+    auto b2 = read("www/b.js");
+    read("www/a.js");
+    auto c2 = read("www/c.js");
+    if (vfs.decoded_cache_size() != 2 * DECODED_SIZE) return fail("two entries did not fit a limit of two");
+    if (!same_buffer(a2, read("www/a.js"))) return fail("the most recently used entry was evicted");
+    if (!same_buffer(c2, read("www/c.js"))) return fail("the newest entry was evicted");
+    if (same_buffer(b2, read("www/b.js"))) return fail("the least recently used entry survived");
+    
+    // lowering the limit evicts at once, but buffers already handed out stay valid
+    vfs.set_decoded_cache_limit(0);
+    if (vfs.decoded_cache_size() != 0) return fail("lowering the limit did not evict");
+    if (a2->text() != files[0].data || c2->text() != files[2].data) return fail("an evicted buffer was freed under a reader");
+    
+    auto small = read("www/small.js");
+    if (!small || small->text() != "tiny") return fail("an uncompressed entry did not read back");
+    return true;
+}
+
+int main() {
+    bool ok = run();
+    std::remove(PACK_PATH);
+    if (!ok) return 1;
+    std::printf("decoded_cache: zstd entries decoded and evicted as expected\n");
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// builds minimal perfect hashes the way `valkyrie embed` does and looks every
+// path up through embedded_table::find, including paths that are not in the
+// table and a table with no files at all
+
+#include "cli/embed.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+static bool check_table(const std::vector<asset_file>& files, const std::vector<std::string>& misses) {
+    std::vector<uint32_t> displacements;
+    std::vector<size_t> slot_of;
+    if (!plan_embedded_index(files, "embedded_hash", displacements, slot_of)) {
+        std::fprintf(stderr, "embedded_hash: no perfect hash for %zu file(s)\n", files.size());
+        return false;
+    }
+    if (displacements.empty()) {
+        std::fprintf(stderr, "embedded_hash: %zu file(s) got no buckets\n", files.size());
+        return false;
+    }
+    
+    // laid out in slot order, as generate_embedded_table and build_asset_pack do
+    std::vector<valkyrie::embedded_file> slots(files.size());
+    std::vector<bool> taken(files.size(), false);
+    for (size_t i = 0; i < files.size(); i++) {
+        size_t slot = slot_of[i];
+        if (slot >= files.size() || taken[slot]) {
+            std::fprintf(stderr, "embedded_hash: %s landed on slot %zu twice or out of range\n",
+                         files[i].path.c_str(), slot);
+            return false;
+        }
+        taken[slot] = true;
+        const auto& file = files[i];
+        slots[slot] = valkyrie::embedded_file{file.path, (const uint8_t*)file.data.data(), file.data.size(),
+                                              "text/plain", valkyrie::fnv1a_hash(file.data.data(), file.data.size())};
+    }
+    valkyrie::embedded_table table{slots.data(), slots.size(), displacements.data(), displacements.size()};
+    
+    for (const auto& file : files) {
+        const valkyrie::embedded_file* found = table.find(file.path);
+        if (!found || found->path != file.path || found->size != file.data.size()) {
+            std::fprintf(stderr, "embedded_hash: lookup of %s failed in a table of %zu\n",
+                         file.path.c_str(), files.size());
+            return false;
+        }
+    }
+    for (const auto& path : misses) {
+        if (table.find(path)) {
+            std::fprintf(stderr, "embedded_hash: %s found in a table of %zu that does not hold it\n",
+                         path.c_str(), files.size());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::vector<std::string> misses = {"", "/", "www/missing.js", "index.htm", "www/index.html/", "WWW/INDEX.HTML"};
+    
+    // an empty table, small ones, and sizes that need the bucket count to grow
+    for (size_t count : {0, 1, 2, 3, 7, 16, 100, 1000, 5000}) {
+        std::vector<asset_file> files;
+        for (size_t i = 0; i < count; i++) {
+            files.push_back({"www/assets/file" + std::to_string(i) + ".js", "content " + std::to_string(i)});
+        }
+        std::vector<std::string> table_misses = misses;
+        table_misses.push_back("www/assets/file" + std::to_string(count) + ".js");
+        if (!check_table(files, table_misses)) return 1;
+    }
+    
+    // paths that differ only in their last byte or by a prefix
+    std::vector<asset_file> similar = {
+        {"www/index.html", "a"}, {"www/index.htmm", "b"}, {"index.html", "c"}, {"www/index.html.map", "d"},
+    };
+    if (!check_table(similar, misses)) return 1;
+    
+    std::printf("embedded_hash: all lookups matched\n");
+    return 0;
+}
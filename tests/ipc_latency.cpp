@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// measures the native_send -> handleCommand round trip: the main thread plays
+// the webview callback, the backend acks through a native function and the
+// time until the ack lands back on this thread is one sample
+
+#include "valkyrie.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+static constexpr int WARMUP_ROUNDS = 200;
+static constexpr int MEASURED_ROUNDS = 5000;
+static constexpr uint64_t ACK_TIMEOUT_NS = 2'000'000'000ull;
+
+static std::atomic<int32_t> g_acked_seq{-1};
+static std::atomic<uint64_t> g_acked_at{0};
+
+static JSValue js_latency_ack(JSContext* ctx, JSValueConst this_val, int argc, JSValueConst* argv) {
+    int32_t seq = -1;
+    if (argc > 0) JS_ToInt32(ctx, &seq, argv[0]);
+    g_acked_at.store(uv_hrtime(), std::memory_order_relaxed);
+    g_acked_seq.store(seq, std::memory_order_release);
+    return JS_UNDEFINED;
+}
+
+// returns the round trip in ns, or 0 if the backend never answered
+static uint64_t round_trip(valkyrie::app& application, int32_t seq) {
+    uint64_t sent = uv_hrtime();
+    application.send("{\"command\":\"latency\",\"seq\":" + std::to_string(seq) + "}");
+    
+    while (g_acked_seq.load(std::memory_order_acquire) != seq) {
+        if (uv_hrtime() - sent > ACK_TIMEOUT_NS) return 0;
+        std::this_thread::yield();
+    }
+    return g_acked_at.load(std::memory_order_relaxed) - sent;
+}
+
+int main() {
+    valkyrie::app application;
+    application.init();
+    
+    application.post([](JSContext* ctx) {
+        JSValue global = JS_GetGlobalObject(ctx);
+        JS_SetPropertyStr(ctx, global, "__latency_ack", JS_NewCFunction(ctx, js_latency_ack, "__latency_ack", 1));
+        JS_FreeValue(ctx, global);
+    });
+    application.load_script("function handleCommand(msg) { __latency_ack(msg.seq); }", "<ipc_latency>");
+    
+    int32_t seq = 0;
+    for (int i = 0; i < WARMUP_ROUNDS; i++) {
+        if (round_trip(application, seq++) == 0) {
+            std::fprintf(stderr, "ipc_latency: backend did not answer during warmup\n");
+            return 1;
+        }
+    }
+    
+    std::vector<uint64_t> samples;
+    samples.reserve(MEASURED_ROUNDS);
+    for (int i = 0; i < MEASURED_ROUNDS; i++) {
+        uint64_t elapsed = round_trip(application, seq++);
+        if (elapsed == 0) {
+            std::fprintf(stderr, "ipc_latency: message %d timed out\n", static_cast<int>(seq - 1));
+            return 1;
+        }
+        samples.push_back(elapsed);
+    }
+    application.stop();
+    
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+        return static_cast<double>(samples[index]) / 1000.0;
+    };
+    
+    std::printf("native_send -> handleCommand round trip over %d messages\n", MEASURED_ROUNDS);
+    std::printf("  p50 %.1f us  p90 %.1f us  p99 %.1f us  max %.1f us\n",
+        percentile(0.50), percentile(0.90), percentile(0.99), percentile(1.0));
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026 Kitsuri Studios
+ * Developed by Mostafizur Rahman (aeticusdev)
+ *
+ * SUMMARY (BSD 3-Clause License):
+ *  You may use, copy, modify, and distribute this software
+ *  You may use it for commercial and private purposes
+ *  You must include this copyright notice and license text
+ *  You may NOT use the project name or contributors to endorse derived products
+ *  No warranty or liability is provided by the authors
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// the sampling profiler reads stacks from a fresh Error inside the interrupt
+// handler. runs a busy function under the profiler and checks that its name
+// made it into the folded output, which fails if stacks come back empty.
+
+#include "valkyrie.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+int main() {
+    std::string path = "profiler_stack.folded";
+    std::remove(path.c_str());
+    
+    valkyrie::runtime_options options;
+    options.profile_path = path;
+    options.profile_interval_us = 200;
+    
+    valkyrie::app application(options);
+    application.init();
+    application.load_script(
+        "function knownHotFunction() {\n"
+        "    let n = 0;\n"
+        "    const end = Date.now() + 300;\n"
+        "    while (Date.now() < end) n++;\n"
+        "    return n;\n"
+        "}\n"
+        "knownHotFunction();\n",
+        "profiler_stack.js");
+    application.stop();
+    
+    std::ifstream in(path);
+    std::stringstream folded;
+    folded << in.rdbuf();
+    std::string output = folded.str();
+    std::remove(path.c_str());
+    
+    if (output.empty()) {
+        std::fprintf(stderr, "profiler_stack: no samples were recorded\n");
+        return 1;
+    }
+    if (output.find("knownHotFunction") == std::string::npos) {
+        std::fprintf(stderr, "profiler_stack: samples miss knownHotFunction:\n%s\n", output.c_str());
+        return 1;
+    }
+    std::printf("profiler_stack: knownHotFunction sampled\n");
+    return 0;
+}